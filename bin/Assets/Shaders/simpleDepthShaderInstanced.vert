@@ -0,0 +1,10 @@
+#version 430
+layout(location=0) in vec3 aPos;
+layout(location=4) in mat4 model;
+
+uniform mat4 viewProjection;
+
+void main()
+{
+	gl_Position = viewProjection * model * vec4(aPos, 1);
+}
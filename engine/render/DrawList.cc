@@ -0,0 +1,100 @@
+#include "config.h"
+#include "DrawList.h"
+#include <algorithm>
+
+void DrawList::Clear()
+{
+	mCommands.clear();
+	mBatches.clear();
+	mSortedTransforms.clear();
+}
+
+void DrawList::Add(RenderPass Pass, MeshResource* Mesh, ShaderResource* Shader, const mat4& Transform)
+{
+	/// Pass first so each pass is one contiguous range, then shader since switching programs costs more than switching meshes
+	uint64_t SortKey = ((uint64_t)Pass << 56) | ((uint64_t)(GetSortId(Shader) & 0xFFFFFF) << 32) | GetSortId(Mesh);
+	mCommands.push_back({ SortKey, Pass, Mesh, Shader, Transform });
+}
+
+void DrawList::AddNode(const GraphicsNode& Node, uint32_t PassMask)
+{
+	AddMeshes(Node.meshes, Node.transform, PassMask);
+}
+
+void DrawList::AddMeshes(const std::vector<std::shared_ptr<MeshResource>>& Meshes, const mat4& Transform, uint32_t PassMask)
+{
+	for (int Pass = 0; Pass < (int)RenderPass::Count; Pass++)
+	{
+		if (mPassShaders[Pass] == nullptr || (PassMask & (1u << Pass)) == 0)
+			continue;
+
+		for (auto& Mesh : Meshes)
+			Add((RenderPass)Pass, Mesh.get(), mPassShaders[Pass].get(), Transform);
+	}
+}
+
+uint32_t DrawList::GetSortId(const void* Resource)
+{
+	auto [It, bInserted] = mSortIds.insert({ Resource, (uint32_t)mSortIds.size() });
+	return It->second;
+}
+
+void DrawList::Sort()
+{
+	/// Sort the keys with the command index alongside, the index breaks ties so commands keep the order they were added in
+	std::vector<std::pair<uint64_t, uint32_t>> Order;
+	Order.reserve(mCommands.size());
+	for (uint32_t i = 0; i < mCommands.size(); i++)
+		Order.push_back({ mCommands[i].mSortKey, i });
+	std::sort(Order.begin(), Order.end());
+
+	mBatches.clear();
+	mSortedTransforms.clear();
+	mSortedTransforms.reserve(mCommands.size());
+
+	for (auto& [SortKey, Index] : Order)
+	{
+		const DrawCommand& Command = mCommands[Index];
+
+		if (mBatches.empty() || mBatches.back().mPass != Command.mPass || mBatches.back().mShader != Command.mShader || mBatches.back().mMesh != Command.mMesh)
+			mBatches.push_back({ Command.mPass, Command.mMesh, Command.mShader, (unsigned int)mSortedTransforms.size(), 0 });
+
+		mBatches.back().mCount++;
+		mSortedTransforms.push_back(Command.mTransform);
+	}
+
+	mVersion++;
+}
+
+void NullRenderBackend::Submit(const DrawList& List, RenderPass Pass, const mat4& ViewProjection)
+{
+	mStats.mSubmits++;
+
+	ShaderResource* LastShader = nullptr;
+	MeshResource* LastMesh = nullptr;
+
+	for (const DrawBatch& Batch : List.mBatches)
+	{
+		if (Batch.mPass != Pass)
+			continue;
+
+		if (Batch.mShader != LastShader)
+			mStats.mShaderChanges++;
+		if (Batch.mMesh != LastMesh)
+			mStats.mMeshChanges++;
+		LastShader = Batch.mShader;
+		LastMesh = Batch.mMesh;
+
+		mStats.mDrawCalls++;
+		mStats.mInstances += Batch.mCount;
+
+		if (bRecord)
+			mRecorded.push_back(Batch);
+	}
+}
+
+void NullRenderBackend::Reset()
+{
+	mStats = Stats();
+	mRecorded.clear();
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include "render/GraphicsNode.h"
+#include "core/math/mat4.h"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+enum class RenderPass : uint8_t
+{
+	Shadow,
+	Main,
+	Count
+};
+
+/// One bit per pass, for choosing which passes something is recorded into
+static const uint32_t AllRenderPasses = (1u << (int)RenderPass::Count) - 1;
+
+/// One mesh to be drawn once in one pass, the material is the one the mesh carries
+struct DrawCommand
+{
+	uint64_t mSortKey;
+	RenderPass mPass;
+	MeshResource* mMesh;
+	ShaderResource* mShader;
+	mat4 mTransform;
+};
+
+/// A run of sorted commands that share pass, shader and mesh, so they can go out as one instanced draw.
+/// Their transforms are mSortedTransforms[mFirst] up to mSortedTransforms[mFirst + mCount]
+struct DrawBatch
+{
+	RenderPass mPass;
+	MeshResource* mMesh;
+	ShaderResource* mShader;
+	unsigned int mFirst;
+	unsigned int mCount;
+};
+
+/// Everything that should be drawn in a frame, recorded instead of drawn right away so it can be sorted and batched before a backend submits it.
+/// Nothing in here touches GL, so recording, sorting and batching can be run and checked without a GL context
+class DrawList
+{
+public:
+	std::vector<DrawCommand> mCommands;
+	/// Filled by Sort
+	std::vector<DrawBatch> mBatches;
+	std::vector<mat4> mSortedTransforms;
+	/// Goes up every time the list is sorted, so a backend can tell whether it already uploaded these transforms
+	unsigned int mVersion = 0;
+
+	/// The shader every node is drawn with in each pass, null skips that pass for nodes. The shaders read the transform per instance
+	std::shared_ptr<ShaderResource> mPassShaders[(int)RenderPass::Count];
+
+	void Clear();
+	void Add(RenderPass Pass, MeshResource* Mesh, ShaderResource* Shader, const mat4& Transform);
+	/// Adds every mesh of the node to the passes in PassMask that have a shader, bit i is RenderPass i
+	void AddNode(const GraphicsNode& Node, uint32_t PassMask = AllRenderPasses);
+	void AddMeshes(const std::vector<std::shared_ptr<MeshResource>>& Meshes, const mat4& Transform, uint32_t PassMask = AllRenderPasses);
+
+	/// Sorts by pass, then shader, then mesh, keeping the order things were added in otherwise, and merges the runs into mBatches
+	void Sort();
+
+	/// Small ids handed out in the order shaders and meshes are first seen, they make up the sort key.
+	/// They are kept across frames so the order stays the same from one frame to the next
+	std::unordered_map<const void*, uint32_t> mSortIds;
+	uint32_t GetSortId(const void* Resource);
+};
+
+/// Takes a sorted DrawList and draws one pass of it
+class RenderBackend
+{
+public:
+	virtual ~RenderBackend() = default;
+	virtual void Submit(const DrawList& List, RenderPass Pass, const mat4& ViewProjection) = 0;
+};
+
+/// Draws nothing and only counts what would have been drawn, optionally keeping a copy of every batch it was given.
+/// For measuring and checking sorting, culling and batching on machines without a GPU
+class NullRenderBackend : public RenderBackend
+{
+public:
+	struct Stats
+	{
+		unsigned int mSubmits = 0;
+		unsigned int mDrawCalls = 0;
+		unsigned int mInstances = 0;
+		/// How often consecutive draws had to switch shader or mesh, the number sorting is meant to bring down
+		unsigned int mShaderChanges = 0;
+		unsigned int mMeshChanges = 0;
+	};
+
+	Stats mStats;
+	bool bRecord = false;
+	std::vector<DrawBatch> mRecorded;
+
+	void Submit(const DrawList& List, RenderPass Pass, const mat4& ViewProjection) override;
+	void Reset();
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include "core/math/mat4.h"
+
+/// The six planes of the volume a view projection matrix can see, for throwing away things that can't end up on screen before they are drawn
+class Frustum
+{
+public:
+	/// Left, right, bottom, top, near, far. A point p is inside a plane when dot(plane.xyz, p) + plane.w >= 0
+	vec4 mPlanes[6];
+
+	/// Sees everything, so nothing is culled
+	Frustum()
+	{
+		for (int i = 0; i < 6; i++)
+			mPlanes[i] = vec4(0, 0, 0, 1);
+	}
+
+	/// Takes the planes straight from the rows of the matrix, works for both perspective and orthographic projections
+	Frustum(const mat4& ViewProjection)
+	{
+		/// The matrix is stored as columns, so row r is the r:th component of each column
+		vec4 Rows[4];
+		for (int r = 0; r < 4; r++)
+			Rows[r] = vec4(ViewProjection[0][r], ViewProjection[1][r], ViewProjection[2][r], ViewProjection[3][r]);
+
+		for (int Axis = 0; Axis < 3; Axis++)
+		{
+			mPlanes[Axis * 2] = Rows[3] + Rows[Axis];
+			mPlanes[Axis * 2 + 1] = Rows[3] - Rows[Axis];
+		}
+	}
+
+	/// False only if the whole box is outside one of the planes, boxes near a corner of the frustum can still pass without being visible
+	bool IsBoxVisible(const vec3& Min, const vec3& Max) const
+	{
+		for (int i = 0; i < 6; i++)
+		{
+			const vec4& Plane = mPlanes[i];
+
+			/// The corner of the box furthest along the plane normal, if even that one is behind the plane the whole box is
+			float x = Plane.x >= 0 ? Max.x : Min.x;
+			float y = Plane.y >= 0 ? Max.y : Min.y;
+			float z = Plane.z >= 0 ? Max.z : Min.z;
+
+			if (Plane.x * x + Plane.y * y + Plane.z * z + Plane.w < 0)
+				return false;
+		}
+		return true;
+	}
+};
@@ -0,0 +1,92 @@
+#include "config.h"
+#include "GLRenderBackend.h"
+#include "GLState.h"
+
+/// The transforms are copied straight into the instance buffer, four columns of four floats
+static_assert(sizeof(mat4) == sizeof(float) * 16, "mat4 has to be tightly packed to be used as instance data");
+
+GLRenderBackend::~GLRenderBackend()
+{
+	if (mInstanceBuffer != 0)
+		glDeleteBuffers(1, &mInstanceBuffer);
+}
+
+void GLRenderBackend::Upload(const DrawList& List)
+{
+	if (mInstanceBuffer == 0)
+		glGenBuffers(1, &mInstanceBuffer);
+
+	mUploadedList = &List;
+	mUploadedVersion = List.mVersion;
+	if (List.mSortedTransforms.empty())
+		return;
+
+	if (List.mSortedTransforms.size() > mCapacity)
+		mCapacity = std::max(List.mSortedTransforms.size(), mCapacity * 2);
+
+	/// Orphan the old storage first so the driver doesn't have to wait for last frame's draws to finish reading it
+	glBindBuffer(GL_ARRAY_BUFFER, mInstanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(mat4) * mCapacity, nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(mat4) * List.mSortedTransforms.size(), List.mSortedTransforms.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	GLState::Get().CountCalls(4);
+}
+
+void GLRenderBackend::PrepareMesh(const MeshResource& Mesh)
+{
+	if (!mPreparedMeshes.insert(&Mesh).second)
+		return;
+
+	/// The instance attribute is added to the mesh's own vertex array, shaders that don't read it are unaffected
+	glBindVertexArray(Mesh.vertexArrayObject);
+	glBindBuffer(GL_ARRAY_BUFFER, mInstanceBuffer);
+	for (unsigned int Column = 0; Column < 4; Column++)
+	{
+		glEnableVertexAttribArray(InstanceAttribute + Column);
+		glVertexAttribPointer(InstanceAttribute + Column, 4, GL_FLOAT, GL_FALSE, sizeof(mat4), (GLvoid*)(sizeof(vec4) * Column));
+		glVertexAttribDivisor(InstanceAttribute + Column, 1);
+	}
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GLRenderBackend::Submit(const DrawList& List, RenderPass Pass, const mat4& ViewProjection)
+{
+	if (mUploadedList != &List || mUploadedVersion != List.mVersion)
+		Upload(List);
+
+	mDrawCallsLastPass = 0;
+	const ShaderResource* LastShader = nullptr;
+	/// The shadow pass only writes depth, so the textures and shininess don't matter there
+	bool bApplyMaterial = Pass == RenderPass::Main;
+
+	for (const DrawBatch& Batch : List.mBatches)
+	{
+		if (Batch.mPass != Pass)
+			continue;
+
+		const MeshResource& Mesh = *Batch.mMesh;
+		PrepareMesh(Mesh);
+
+		if (Batch.mShader != LastShader)
+		{
+			Batch.mShader->SetMatrix("viewProjection", ViewProjection);
+			LastShader = Batch.mShader;
+		}
+		if (bApplyMaterial)
+			Mesh.material.ApplyTo(*Batch.mShader);
+
+		/// The base instance picks where in the shared instance buffer this batch's transforms start
+		glBindVertexArray(Mesh.vertexArrayObject);
+		if (Mesh.indexBuffer)
+			glDrawElementsInstancedBaseInstance(GL_TRIANGLES, Mesh.elementCount, GL_UNSIGNED_INT, 0, Batch.mCount, Batch.mFirst);
+		else
+			glDrawArraysInstancedBaseInstance(GL_TRIANGLES, 0, Mesh.elementCount, Batch.mCount, Batch.mFirst);
+		mDrawCallsLastPass++;
+		GLState::Get().CountCalls();
+		GLState::Get().CountDraw();
+	}
+
+	glBindVertexArray(0);
+	GLState::Get().CountCalls();
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "render/DrawList.h"
+#include <unordered_set>
+
+/// Submits a DrawList with one instanced draw call per batch.
+/// All transforms of a list go into one instance buffer that is uploaded once, every pass after that only picks its range of it
+class GLRenderBackend : public RenderBackend
+{
+public:
+	/// The per instance transform takes up this attribute location and the three after it, the meshes use 0 to 3
+	static const unsigned int InstanceAttribute = 4;
+
+	unsigned int mInstanceBuffer = 0;
+	/// How many transforms mInstanceBuffer has room for
+	size_t mCapacity = 0;
+	/// The list and version last uploaded, a list is only uploaded again once it was sorted again
+	const DrawList* mUploadedList = nullptr;
+	unsigned int mUploadedVersion = 0;
+	/// Meshes whose vertex array already reads the instance attribute from mInstanceBuffer
+	std::unordered_set<const MeshResource*> mPreparedMeshes;
+
+	unsigned int mDrawCallsLastPass = 0;
+
+	~GLRenderBackend() override;
+
+	void Submit(const DrawList& List, RenderPass Pass, const mat4& ViewProjection) override;
+
+	void Upload(const DrawList& List);
+	void PrepareMesh(const MeshResource& Mesh);
+};
@@ -0,0 +1,63 @@
+#include "config.h"
+#include "GLState.h"
+
+GLState::GLState()
+{
+	Invalidate();
+}
+
+GLState& GLState::Get()
+{
+	static GLState State;
+	return State;
+}
+
+void GLState::UseProgram(GLuint Program)
+{
+	if (Program == mProgram)
+	{
+		mCurrentFrame.mSkippedBinds++;
+		return;
+	}
+
+	glUseProgram(Program);
+	mProgram = Program;
+	mCurrentFrame.mCalls++;
+}
+
+void GLState::BindTexture(int Unit, GLuint Texture)
+{
+	assert(Unit >= 0 && Unit < MaxTextureUnits);
+
+	if (mTextures[Unit] == Texture)
+	{
+		mCurrentFrame.mSkippedBinds++;
+		return;
+	}
+
+	if (mActiveUnit != Unit)
+	{
+		glActiveTexture(GL_TEXTURE0 + Unit);
+		mActiveUnit = Unit;
+		mCurrentFrame.mCalls++;
+	}
+
+	glBindTexture(GL_TEXTURE_2D, Texture);
+	mTextures[Unit] = Texture;
+	mCurrentFrame.mCalls++;
+}
+
+void GLState::Invalidate()
+{
+	mProgram = Unknown;
+	mActiveUnit = -1;
+	for (int i = 0; i < MaxTextureUnits; i++)
+		mTextures[i] = Unknown;
+}
+
+void GLState::BeginFrame()
+{
+	mLastFrame = mCurrentFrame;
+	mCurrentFrame = FrameStats();
+	Invalidate();
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <GL/glew.h>
+
+/// Remembers which program and textures are bound so binding the same ones again can be skipped, and counts the GL calls made through the render resources.
+/// Anything that binds behind its back, like the UI, has to be followed by Invalidate, BeginFrame does that once a frame
+class GLState
+{
+public:
+	struct FrameStats
+	{
+		unsigned int mCalls = 0;
+		unsigned int mDrawCalls = 0;
+		/// Binds that were skipped because the program or texture was already bound
+		unsigned int mSkippedBinds = 0;
+		/// Uniform sets that were skipped because the program already had the value
+		unsigned int mSkippedUniforms = 0;
+	};
+
+	static const int MaxTextureUnits = 16;
+	/// Marks a binding as not known, no real GL object has this name
+	static const GLuint Unknown = ~0u;
+
+	GLuint mProgram = Unknown;
+	int mActiveUnit = -1;
+	GLuint mTextures[MaxTextureUnits];
+
+	FrameStats mCurrentFrame;
+	FrameStats mLastFrame;
+
+	/// There is only one GL context, so there is only one of these
+	static GLState& Get();
+
+	void UseProgram(GLuint Program);
+	void BindTexture(int Unit, GLuint Texture);
+	/// Forgets what is bound, the next bind of anything goes through to GL
+	void Invalidate();
+	/// Moves the current stats to mLastFrame and invalidates, call at the start of every frame
+	void BeginFrame();
+
+	/// For GL calls issued directly, so they still show up in the stats
+	void CountCalls(unsigned int Count = 1) { mCurrentFrame.mCalls += Count; }
+	void CountDraw() { mCurrentFrame.mCalls++; mCurrentFrame.mDrawCalls++; }
+	void CountSkippedUniform() { mCurrentFrame.mSkippedUniforms++; }
+
+private:
+	GLState();
+};
@@ -41,16 +41,22 @@ public:
 
 	void Apply()
 	{
-		shader->UseProgram();
+		ApplyTo(*shader);
+	}
+
+	/// Binds the textures and sets the uniforms of this material on a shader other than its own, like an instanced version of it
+	void ApplyTo(const ShaderResource& Shader) const
+	{
+		Shader.UseProgram();
 		texture->BindTexture(0);
 		if (normal != nullptr)
 		{
 			if (normal->texture != 0)
-				shader->SetInt("hasNormal", 1);
+				Shader.SetInt("hasNormal", 1);
 			else
-				shader->SetInt("hasNormal", 0);
+				Shader.SetInt("hasNormal", 0);
 			normal->BindTexture(2);
 		}
-		shader->SetFloat("material.shininess", shininess);
+		Shader.SetFloat("material.shininess", shininess);
 	}
 };
\ No newline at end of file
@@ -59,6 +59,8 @@ public:
 		else
 			glDrawArrays(GL_TRIANGLES, 0, elementCount);
 		glBindVertexArray(0);
+		GLState::Get().CountCalls(2);
+		GLState::Get().CountDraw();
 	}
 
 	std::shared_ptr<MeshResource> MoveToSharedPointer()
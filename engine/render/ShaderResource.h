@@ -1,14 +1,28 @@
 #pragma once
 #include "core/math/mat4.h"
 #include "GL/glew.h"
+#include "render/GLState.h"
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <map>
 
 class ShaderResource
 {
 public:
+	/// A uniform of the linked program, the last int or float written to it is kept so setting the same value again can be skipped
+	struct Uniform
+	{
+		int location = -1;
+		bool hasValue = false;
+		int intValue = 0;
+		float floatValue = 0;
+	};
+
 	unsigned int program;
+	/// Every active uniform by name, filled once when the program is linked so no name has to be looked up through GL while drawing.
+	/// std::less<> lets it be searched with a plain const char* without building a string
+	mutable std::map<std::string, Uniform, std::less<>> uniforms;
 
 	ShaderResource()
 	{
@@ -89,47 +103,128 @@ public:
 
 		glDeleteShader(vertex);
 		glDeleteShader(fragment);
+
+		CacheUniformLocations();
+	}
+
+	/// Asks the linked program for all of its active uniforms once, arrays can be found both with and without their [0]
+	void CacheUniformLocations()
+	{
+		uniforms.clear();
+		if (program == 0)
+			return;
+
+		int count = 0;
+		glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+
+		char name[256];
+		for (int i = 0; i < count; i++)
+		{
+			int length = 0;
+			int size = 0;
+			GLenum type;
+			glGetActiveUniform(program, i, sizeof(name), &length, &size, &type, name);
+
+			Uniform entry;
+			entry.location = glGetUniformLocation(program, name);
+			/// Uniforms in blocks have no location of their own
+			if (entry.location < 0)
+				continue;
+
+			uniforms[std::string(name, length)] = entry;
+			if (length > 3 && std::string(name + length - 3, 3) == "[0]")
+				uniforms[std::string(name, length - 3)] = entry;
+		}
+	}
+
+	/// Null for names the program doesn't have or that were optimized away, setting those would do nothing anyway
+	Uniform* FindUniform(const char* variableName) const
+	{
+		auto it = uniforms.find(variableName);
+		return it != uniforms.end() ? &it->second : nullptr;
 	}
 
 	void UseProgram() const
 	{
-		glUseProgram(program);
+		GLState::Get().UseProgram(program);
 	}
 
+	/// The setters bind the program first like glUniform needs, the bind is skipped when it's already current
 	void SetMatrix(const char* variableName, mat4 m) const
 	{
-		glUseProgram(program);
-		glUniformMatrix4fv(glGetUniformLocation(program, variableName), 1, GL_FALSE, (float*)&m);
+		UseProgram();
+		if (Uniform* uniform = FindUniform(variableName))
+		{
+			glUniformMatrix4fv(uniform->location, 1, GL_FALSE, (float*)&m);
+			GLState::Get().CountCalls();
+		}
 	}
 
 	void SetVec4(const char* variableName, vec4 v) const
 	{
-		glUseProgram(program);
-		glUniform4fv(glGetUniformLocation(program, variableName), 1, (float*)&v);
+		UseProgram();
+		if (Uniform* uniform = FindUniform(variableName))
+		{
+			glUniform4fv(uniform->location, 1, (float*)&v);
+			GLState::Get().CountCalls();
+		}
 	}
 
 	void SetVec3(const char* variableName, vec3 v) const
 	{
-		glUseProgram(program);
-		glUniform3fv(glGetUniformLocation(program, variableName), 1, (float*)&v);
+		UseProgram();
+		if (Uniform* uniform = FindUniform(variableName))
+		{
+			glUniform3fv(uniform->location, 1, (float*)&v);
+			GLState::Get().CountCalls();
+		}
 	}
 
 	void SetFloat(const char* variableName, float f) const
 	{
-		glUseProgram(program);
-		glUniform1f(glGetUniformLocation(program, variableName), f);
+		UseProgram();
+		Uniform* uniform = FindUniform(variableName);
+		if (uniform == nullptr)
+			return;
+
+		if (uniform->hasValue && uniform->floatValue == f)
+		{
+			GLState::Get().CountSkippedUniform();
+			return;
+		}
+
+		glUniform1f(uniform->location, f);
+		uniform->hasValue = true;
+		uniform->floatValue = f;
+		GLState::Get().CountCalls();
 	}
 
 	void SetInt(const char* variableName, int i) const
 	{
-		glUseProgram(program);
-		glUniform1i(glGetUniformLocation(program, variableName), i);
+		UseProgram();
+		Uniform* uniform = FindUniform(variableName);
+		if (uniform == nullptr)
+			return;
+
+		if (uniform->hasValue && uniform->intValue == i)
+		{
+			GLState::Get().CountSkippedUniform();
+			return;
+		}
+
+		glUniform1i(uniform->location, i);
+		uniform->hasValue = true;
+		uniform->intValue = i;
+		GLState::Get().CountCalls();
 	}
 
 	void Destroy()
 	{
-		glDeleteProgram(program);
+		/// Skip the GL call for programs that were never loaded, so shaders can be created and destroyed without a GL context
+		if (program != 0)
+			glDeleteProgram(program);
 		program = 0;
+		uniforms.clear();
 	}
 
 	ShaderResource(const ShaderResource&) = delete;
@@ -138,12 +233,14 @@ public:
 
 	ShaderResource(ShaderResource&& other) noexcept {
 		program = other.program;
+		uniforms = std::move(other.uniforms);
 		other.program = 0;
 	}
 
 	ShaderResource& operator=(ShaderResource&& other) noexcept {
 		Destroy();
 		program = other.program;
+		uniforms = std::move(other.uniforms);
 		other.program = 0;
 		return *this;
 	};
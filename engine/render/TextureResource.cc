@@ -1,5 +1,6 @@
 #include "config.h"
 #include "TextureResource.h"
+#include "GLState.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 #include <iostream>
@@ -20,7 +21,8 @@ TextureResource::TextureResource(const char* filename)
 
 TextureResource::~TextureResource()
 {
-	glDeleteTextures(1, &texture);
+	if (texture != 0)
+		glDeleteTextures(1, &texture);
 }
 
 void TextureResource::LoadFromFile(const char* filename)
@@ -43,6 +45,8 @@ void TextureResource::LoadFromFile(const char* filename)
 		else if (nrChannels == 4)
 			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
 		glGenerateMipmap(GL_TEXTURE_2D);
+		/// The texture was bound without going through the state cache
+		GLState::Get().Invalidate();
 
 		stbi_image_free(data);
 	}
@@ -56,8 +60,7 @@ void TextureResource::LoadFromFile(const char* filename)
 
 void TextureResource::BindTexture(int bind)
 {
-	glActiveTexture(GL_TEXTURE0 + bind);
-	glBindTexture(GL_TEXTURE_2D, texture);
+	GLState::Get().BindTexture(bind, texture);
 }
 
 std::shared_ptr<TextureResource> TextureResource::MoveToSharedPointer()
@@ -4,6 +4,7 @@
 //------------------------------------------------------------------------------
 #include "config.h"
 #include "grid.h"
+#include "GLState.h"
 #include <array>
 
 namespace Render
@@ -125,7 +126,7 @@ Grid::~Grid()
 void
 Grid::Draw(float const* const viewProjection)
 {
-	glUseProgram(this->program);
+	GLState::Get().UseProgram(this->program);
 	glBindVertexArray(this->vao);
 	glUniformMatrix4fv(0, 1, false, viewProjection);
 	glDrawArrays(GL_LINES, 0, gridSize * 2 * 2);
@@ -1,31 +1,5 @@
 #include "BoundingBox.h"
 
-static bool IsSorted(const std::vector<std::pair<int, float>>& Arr)
-{
-    for (int i = 0; i < Arr.size() - 1; i++)
-    {
-        if (Arr[i + 1].second < Arr[i].second)
-            return false;
-    }
-    return true;
-}
-
-static void SortArr(std::vector<std::pair<int, float>>& Arr)
-{
-    while (!IsSorted(Arr))
-    {
-        for (int i = 0; i < Arr.size(); i++)
-        {
-            int j = i;
-            while (j < Arr.size() - 1 && Arr[j].second > Arr[j + 1].second)
-                j++;
-            std::pair<int, float> Temp = Arr[j];
-            Arr[j] = Arr[i];
-            Arr[i] = Temp;
-        }
-    }
-}
-
 BoundingBox::BoundingBox(vec3 Position, vec3 Scale)
 {
 	Min = Position - Scale;
@@ -40,26 +14,12 @@ BoundingBox::BoundingBox()
 	Max = vec3();
 }
 
-bool BoundingBox::IsColliding(BoundingBox Other)
+bool BoundingBox::IsColliding(BoundingBox Other) const
 {
-	std::vector<std::pair<int, float>> Sort;
-
-	Sort = { {0, Min.x}, {0, Max.x}, {1, Other.Min.x}, {1, Other.Max.x} };
-	SortArr(Sort);
-	if (Sort[0].first == Sort[1].first)
-		return false;
-
-	Sort = { {0, Min.y}, {0, Max.y}, {1, Other.Min.y}, {1, Other.Max.y} };
-	SortArr(Sort);
-	if (Sort[0].first == Sort[1].first)
-		return false;
-
-	Sort = { {0, Min.z}, {0, Max.z}, {1, Other.Min.z}, {1, Other.Max.z} };
-	SortArr(Sort);
-	if (Sort[0].first == Sort[1].first)
-		return false;
-
-	return true;
+	/// Boxes that only touch don't count as colliding, since parts are placed right on the surface of their parent
+	return (Min.x < Other.Max.x) & (Other.Min.x < Max.x)
+		& (Min.y < Other.Max.y) & (Other.Min.y < Max.y)
+		& (Min.z < Other.Max.z) & (Other.Min.z < Max.z);
 }
 
 bool BoundingBox::PointIsInShape(vec3 Point) const
@@ -115,3 +75,75 @@ vec3 BoundingBox::GetScale() const
 {
 	return ((Max - Min) * 0.5);
 }
+
+void BoundingBoxSet::Add(const BoundingBox& Box)
+{
+	mMinX.push_back(Box.Min.x);
+	mMinY.push_back(Box.Min.y);
+	mMinZ.push_back(Box.Min.z);
+	mMaxX.push_back(Box.Max.x);
+	mMaxY.push_back(Box.Max.y);
+	mMaxZ.push_back(Box.Max.z);
+}
+
+void BoundingBoxSet::Remove(int Index)
+{
+	mMinX.erase(mMinX.begin() + Index);
+	mMinY.erase(mMinY.begin() + Index);
+	mMinZ.erase(mMinZ.begin() + Index);
+	mMaxX.erase(mMaxX.begin() + Index);
+	mMaxY.erase(mMaxY.begin() + Index);
+	mMaxZ.erase(mMaxZ.begin() + Index);
+}
+
+BoundingBox BoundingBoxSet::Get(int Index) const
+{
+	BoundingBox Box;
+	Box.Min = vec3(mMinX[Index], mMinY[Index], mMinZ[Index]);
+	Box.Max = vec3(mMaxX[Index], mMaxY[Index], mMaxZ[Index]);
+	return Box;
+}
+
+int BoundingBoxSet::Size() const
+{
+	return (int)mMinX.size();
+}
+
+bool BoundingBoxSet::IsColliding(const BoundingBox& Box, int ToIgnore) const
+{
+	const int Count = Size();
+
+	const __m128 BoxMinX = _mm_set1_ps(Box.Min.x);
+	const __m128 BoxMinY = _mm_set1_ps(Box.Min.y);
+	const __m128 BoxMinZ = _mm_set1_ps(Box.Min.z);
+	const __m128 BoxMaxX = _mm_set1_ps(Box.Max.x);
+	const __m128 BoxMaxY = _mm_set1_ps(Box.Max.y);
+	const __m128 BoxMaxZ = _mm_set1_ps(Box.Max.z);
+
+	int i = 0;
+	for (; i + 4 <= Count; i += 4)
+	{
+		/// Same test as BoundingBox::IsColliding, for four boxes at once
+		__m128 Overlap = _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(&mMinX[i]), BoxMaxX), _mm_cmplt_ps(BoxMinX, _mm_loadu_ps(&mMaxX[i])));
+		Overlap = _mm_and_ps(Overlap, _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(&mMinY[i]), BoxMaxY), _mm_cmplt_ps(BoxMinY, _mm_loadu_ps(&mMaxY[i]))));
+		Overlap = _mm_and_ps(Overlap, _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(&mMinZ[i]), BoxMaxZ), _mm_cmplt_ps(BoxMinZ, _mm_loadu_ps(&mMaxZ[i]))));
+
+		int Mask = _mm_movemask_ps(Overlap);
+		if (ToIgnore >= i && ToIgnore < i + 4)
+			Mask &= ~(1 << (ToIgnore - i));
+
+		if (Mask != 0)
+			return true;
+	}
+
+	/// Whatever doesn't fill a full group of four
+	for (; i < Count; i++)
+	{
+		if (i == ToIgnore)
+			continue;
+
+		if (Get(i).IsColliding(Box))
+			return true;
+	}
+	return false;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "config.h"
 #include "core/math/vec3.h"
 #include <vector>
 
@@ -11,10 +12,26 @@ public:
 
     BoundingBox(vec3 Position, vec3 Scale);
     BoundingBox();
-    bool IsColliding(BoundingBox Other);
+    bool IsColliding(BoundingBox Other) const;
     bool PointIsInShape(vec3 Point) const;
     vec3 CalcDistanceToPoint(vec3 Point);
     void Move(vec3 Diff);
     vec3 GetPosition() const;
     vec3 GetScale() const;
 };
+
+/// A list of bounding boxes stored as one array per component, so a single box can be tested against all of them four at a time
+class BoundingBoxSet
+{
+public:
+    std::vector<float> mMinX, mMinY, mMinZ;
+    std::vector<float> mMaxX, mMaxY, mMaxZ;
+
+    void Add(const BoundingBox& Box);
+    void Remove(int Index);
+    BoundingBox Get(int Index) const;
+    int Size() const;
+
+    /// True if Box overlaps any box in the set except the one at ToIgnore
+    bool IsColliding(const BoundingBox& Box, int ToIgnore = -1) const;
+};
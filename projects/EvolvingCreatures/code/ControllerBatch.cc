@@ -0,0 +1,118 @@
+#include "ControllerBatch.h"
+#include "Creature.h"
+#include <emmintrin.h>
+
+/// sin of four values, accurate to about 1e-7 over the range of phases the controllers produce
+static inline __m128 Sin4(__m128 x)
+{
+	const __m128 InvTwoPi = _mm_set1_ps(0.15915494309189535f);
+	/// 2pi split in two so the range reduction doesn't lose precision for larger phases
+	const __m128 TwoPiHigh = _mm_set1_ps(6.28125f);
+	const __m128 TwoPiLow = _mm_set1_ps(0.0019353071795864769f);
+	const __m128 Pi = _mm_set1_ps(3.14159265358979f);
+	const __m128 HalfPi = _mm_set1_ps(1.57079632679490f);
+	const __m128 SignMask = _mm_set1_ps(-0.0f);
+
+	/// Bring x into [-pi, pi]
+	__m128 Turns = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(x, InvTwoPi)));
+	x = _mm_sub_ps(x, _mm_mul_ps(Turns, TwoPiHigh));
+	x = _mm_sub_ps(x, _mm_mul_ps(Turns, TwoPiLow));
+
+	/// Then into [-pi/2, pi/2] using sin(pi - x) = sin(x)
+	__m128 Sign = _mm_and_ps(x, SignMask);
+	__m128 Abs = _mm_andnot_ps(SignMask, x);
+	__m128 Folded = _mm_sub_ps(Pi, Abs);
+	__m128 UseFolded = _mm_cmpgt_ps(Abs, HalfPi);
+	Abs = _mm_or_ps(_mm_and_ps(UseFolded, Folded), _mm_andnot_ps(UseFolded, Abs));
+	x = _mm_or_ps(Abs, Sign);
+
+	/// Taylor series up to x^11, the error at pi/2 is below float precision
+	__m128 x2 = _mm_mul_ps(x, x);
+	__m128 Poly = _mm_set1_ps(-2.5052108385441720e-8f);
+	Poly = _mm_add_ps(_mm_mul_ps(Poly, x2), _mm_set1_ps(2.7557319223985893e-6f));
+	Poly = _mm_add_ps(_mm_mul_ps(Poly, x2), _mm_set1_ps(-1.9841269841269841e-4f));
+	Poly = _mm_add_ps(_mm_mul_ps(Poly, x2), _mm_set1_ps(8.3333333333333333e-3f));
+	Poly = _mm_add_ps(_mm_mul_ps(Poly, x2), _mm_set1_ps(-1.6666666666666667e-1f));
+	return _mm_add_ps(x, _mm_mul_ps(_mm_mul_ps(Poly, x2), x));
+}
+
+void SinBatch(const float* Values, float* Results, int Count)
+{
+	int i = 0;
+	for (; i + 4 <= Count; i += 4)
+	{
+		_mm_storeu_ps(&Results[i], Sin4(_mm_loadu_ps(&Values[i])));
+	}
+
+	/// Whatever doesn't fill a full group of four goes through the same kernel, so a joint gets the same target wherever it is in the batch
+	if (i < Count)
+	{
+		float Remainder[4] = { 0, 0, 0, 0 };
+		for (int j = i; j < Count; j++)
+			Remainder[j - i] = Values[j];
+
+		_mm_storeu_ps(Remainder, Sin4(_mm_loadu_ps(Remainder)));
+
+		for (int j = i; j < Count; j++)
+			Results[j] = Remainder[j - i];
+	}
+}
+
+void ControllerBatch::Clear()
+{
+	mDofIndices.clear();
+	mMaxJointVel.clear();
+	mJointOscillationSpeed.clear();
+	mTargets.clear();
+	mCreatures.clear();
+	mCreatureFirstJoint.assign(1, 0);
+}
+
+void ControllerBatch::Add(Creature* CreatureToAdd)
+{
+	assert(CreatureToAdd->mCache != nullptr);
+
+	for (const JointController& Controller : CreatureToAdd->mJointControllers)
+	{
+		if (Controller.mDofIndex < 0)
+			continue;
+
+		mDofIndices.push_back(Controller.mDofIndex);
+		mMaxJointVel.push_back(Controller.mMaxJointVel);
+		mJointOscillationSpeed.push_back(Controller.mJointOscillationSpeed);
+	}
+
+	mTargets.resize(mDofIndices.size());
+	mCreatures.push_back(CreatureToAdd);
+	mCreatureFirstJoint.push_back(mDofIndices.size());
+}
+
+int ControllerBatch::NumCreatures() const
+{
+	return (int)mCreatures.size();
+}
+
+void ControllerBatch::Activate(const float* Lifetimes, const uint8_t* Active)
+{
+	for (int i = 0; i < NumCreatures(); i++)
+	{
+		for (int j = mCreatureFirstJoint[i]; j < mCreatureFirstJoint[i + 1]; j++)
+			mTargets[j] = mJointOscillationSpeed[j] * Lifetimes[i];
+	}
+
+	SinBatch(mTargets.data(), mTargets.data(), mTargets.size());
+
+	/// Scatter the targets into each creature's cache and hand them over in a single call per articulation
+	for (int i = 0; i < NumCreatures(); i++)
+	{
+		if (!Active[i])
+			continue;
+
+		physx::PxReal* TargetVelocities = mCreatures[i]->mCache->jointTargetVelocities;
+
+		for (int j = mCreatureFirstJoint[i]; j < mCreatureFirstJoint[i + 1]; j++)
+			TargetVelocities[mDofIndices[j]] = mMaxJointVel[j] * mTargets[j];
+
+		mCreatures[i]->PushJointTargets();
+	}
+}
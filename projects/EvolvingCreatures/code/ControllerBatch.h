@@ -0,0 +1,36 @@
+#pragma once
+
+#include "config.h"
+#include <vector>
+
+class Creature;
+
+/// The oscillator controllers of a whole population packed into one array per parameter, so every joint target can be
+/// computed with a four wide sin in one pass before being handed to the drives
+class ControllerBatch
+{
+public:
+	/// One entry per driven joint, all parallel, locked joints are left out
+	std::vector<int> mDofIndices;
+	std::vector<float> mMaxJointVel;
+	std::vector<float> mJointOscillationSpeed;
+	/// Scratch space, holds the phase of every joint and then the target velocity
+	std::vector<float> mTargets;
+
+	/// Every creature that was added, the targets are pushed to each of them through their articulation cache
+	std::vector<Creature*> mCreatures;
+	/// Joints mCreatureFirstJoint[i] up to mCreatureFirstJoint[i + 1] belong to mCreatures[i]
+	std::vector<int> mCreatureFirstJoint = { 0 };
+
+	void Clear();
+	/// The creature must already be in a scene, the degree of freedom indices aren't known before that
+	void Add(Creature* CreatureToAdd);
+	int NumCreatures() const;
+
+	/// Sets the drive target velocity of every joint, Lifetimes holds the time passed for each creature in the order they were added.
+	/// Creatures with a 0 in Active are skipped, pushing targets to an articulation wakes it up
+	void Activate(const float* Lifetimes, const uint8_t* Active);
+};
+
+/// Writes sin(Values[i]) into Results[i], four at a time with SSE, Results may be the same array as Values
+void SinBatch(const float* Values, float* Results, int Count);
@@ -1,269 +1,74 @@
 #include "Creature.h"
-#include "RandomUtils.h"
-#include "flatbuffers/flatbuffers.h"
-#include "Creature_generated.h"
+#include <atomic>
 
-Creature::Creature(physx::PxPhysics* Physics, physx::PxMaterial* PhysicsMaterial, physx::PxShapeFlags ShapeFlags, GraphicsNode Node, vec3 Scale)
+/// Creatures are built on several threads at once
+static std::atomic<uint64_t> NextCreatureId = 1;
+
+Creature::Creature(const CreatureGenome& Genome, physx::PxPhysics* Physics, physx::PxMaterial* PhysicsMaterial, physx::PxShapeFlags ShapeFlags) : mGenome(Genome), mId(NextCreatureId++)
 {
 	mArticulation = Physics->createArticulationReducedCoordinate();
 	//mArticulation->setArticulationFlag(physx::PxArticulationFlag::eDISABLE_SELF_COLLISION, true);
 
-	//mRootPart = new CreaturePart(this, PhysicsMaterial, ShapeFlags);
-	mRootPart = new CreaturePart(PhysicsMaterial, ShapeFlags, 0, 0);
-	mRootPart->mLink = mArticulation->createLink(NULL, physx::PxTransform(physx::PxIdentity));
-
-	mRootPart->AddBoxShape(Physics, Scale, Node);
-
-	mShapes.emplace(mRootPart, BoundingBox(vec3(), Scale));
-}
-
-Creature::~Creature()
-{
-	delete mRootPart;
-	mArticulation->release();
-}
-
-CreaturePart* Creature::GetChildlessPart() const
-{
-	CreaturePart* CurrentPart = mRootPart;
-
-	while (CurrentPart->mChildren.size() > 0)
-		CurrentPart = CurrentPart->mChildren[RandomInt(CurrentPart->mChildren.size())];
+	mParts.reserve(mGenome.mParts.size());
 
-	return CurrentPart;
-}
-
-void Creature::RemoveChildlessPart()
-{
-	CreaturePart* Parent = nullptr;
-	CreaturePart* CurrentPart = mRootPart;
-	int ChildIndex = 0;
+	CreaturePart RootPart(PhysicsMaterial, ShapeFlags, 0, 0);
+	RootPart.mLink = mArticulation->createLink(NULL, physx::PxTransform(physx::PxIdentity));
+	RootPart.AddBoxShape(Physics, mGenome.mParts[0].mScale);
+	mParts.push_back(RootPart);
 
-	while (CurrentPart->mChildren.size() > 0)
+	/// The genome is in topological order, so the parent of every part has already been built when we get to it
+	for (int i = 1; i < mGenome.mParts.size(); i++)
 	{
-		Parent = CurrentPart;
-		ChildIndex = RandomInt(CurrentPart->mChildren.size());
-		CurrentPart = CurrentPart->mChildren[ChildIndex];
-	}
+		const PartGene& Gene = mGenome.mParts[i];
 
-	if (Parent == nullptr)
-	{
-		std::cout << "NOTE: Invoked Creature::RemoveChildlessPart() on a creature with no children\n";
-		return;
-	}
-
-	mShapes.erase(CurrentPart);
-	delete Parent->mChildren[ChildIndex];
-	Parent->mChildren.erase(Parent->mChildren.begin() + ChildIndex);
-}
+		physx::PxArticulationDrive PosDrive;
+		PosDrive.stiffness = Gene.mDriveStiffness;
+		PosDrive.damping = Gene.mDriveDamping;
+		PosDrive.maxForce = Gene.mDriveMaxForce;
+		PosDrive.driveType = physx::PxArticulationDriveType::eACCELERATION;
 
-CreaturePart* Creature::GetRandomPart()
-{
-	std::vector<CreaturePart*> Parts = GetAllParts();
-	return Parts[rand() % Parts.size()];
-}
+		physx::PxArticulationLimit JointLimit;
+		JointLimit.low = Gene.mJointLowLimit;
+		JointLimit.high = Gene.mJointHighLimit;
 
-std::vector<CreaturePart*> Creature::GetAllParts()
-{
-	return GetAllPartsFrom(mRootPart);
-}
-
-std::vector<CreaturePart*> Creature::GetAllPartsFrom(CreaturePart* Part)
-{
-	std::vector<CreaturePart*> Parts;
-
-	if (Part->mChildren.size() == 0)
-	{
-		return { Part };
+		CreaturePart NewPart = mParts[Gene.mParentIndex].CreateChild(Physics, mArticulation, PhysicsMaterial, ShapeFlags, Gene.mScale, 
+											Gene.mRelativePosition, Gene.mJointPosition, Gene.mMaxJointVel, Gene.mJointOscillationSpeed, 
+											(physx::PxArticulationAxis::Enum)Gene.mJointAxis, PosDrive, (physx::PxArticulationMotion::Enum)Gene.mJointMotion, JointLimit);
+		mParts.push_back(NewPart);
 	}
 
-	for (auto iPart : Part->mChildren)
+	mJointControllers.reserve(mParts.size() - 1);
+	for (int i = 1; i < mParts.size(); i++)
 	{
-		std::vector<CreaturePart*> Children = GetAllPartsFrom(iPart);
-
-		for (auto ChildPart : Children)
-			Parts.push_back(ChildPart);
+		mJointControllers.push_back({ -1, i, mParts[i].mMaxJointVel, mParts[i].mJointOscillationSpeed });
 	}
-
-	Parts.push_back(Part);
-
-	return Parts;
 }
 
-void Creature::DrawBoundingBoxes(mat4 ViewProjection, vec3 Position, GraphicsNode Node)
+Creature::~Creature()
 {
-	for (auto& [Part, Shape] : mShapes)
-	{
-		Node.transform = translate(Position + Shape.GetPosition()) * scale(Shape.GetScale());
-		Node.draw(ViewProjection);
-	}
-}
+	if (mCache != nullptr)
+		mCache->release();
 
-bool Creature::IsColliding(BoundingBox Box, CreaturePart* ToIgnore)
-{
-	for (auto& [Part, Shape] : mShapes)
+	/// Only leaf links can be released, walking the topological order backwards always gets to the children before their parent
+	for (int i = mParts.size() - 1; i >= 0; i--)
 	{
-		if (Part == ToIgnore)
-			continue;
-
-		if (Shape.IsColliding(Box))
-			return true;
+		mParts[i].mLink->release();
 	}
-	return false;
+	mArticulation->release();
 }
 
-std::pair<BoundingBox, CreaturePart*> Creature::GetRandomShape()
+CreaturePart& Creature::GetRootPart()
 {
-	CreaturePart* ParentPart = GetRandomPart();
-
-	vec3 RandomPointOnParent;
-	vec3 RandomScale;
-	vec3 RandomRelativePosition;
-
-	int TEST_TRIES = 0;
-
-	RandomPointOnParent = ParentPart->mScale;
-
-	/// Pick an axis to place the new shape on
-	int RandAxis = rand() % 3;
-	switch (RandAxis)
-	{
-	case(0):
-		/// Times these values by [-1 , 1] to get a random point on the parent shape
-		RandomPointOnParent.x *= RandomFloatInRange(-1, 1); 
-		RandomPointOnParent.y *= RandomFloatInRange(-1, 1);
-
-		/// Times this value by either -1 or 1 to get the maximum or minimum point
-		RandomPointOnParent.z *= (RandomInt(2) * 2) - 1;
-		break;
-	case(1):
-		RandomPointOnParent.z *= RandomFloatInRange(-1, 1); 
-		RandomPointOnParent.x *= RandomFloatInRange(-1, 1);
-
-		RandomPointOnParent.y *= (RandomInt(2) * 2) - 1;
-		break;
-	case(2):
-		RandomPointOnParent.y *= RandomFloatInRange(-1, 1); 
-		RandomPointOnParent.z *= RandomFloatInRange(-1, 1);
-
-		RandomPointOnParent.x *= (RandomInt(2) * 2) - 1;
-		break;
-	}
-
-	float MAX_SCALE = 3;
-	RandomScale = vec3(RandomFloat(MAX_SCALE), RandomFloat(MAX_SCALE), RandomFloat(MAX_SCALE));
-
-	/// Set the position to be the random point we calculated, but also add a random chance to shift it around based on the shape of the child
-	RandomRelativePosition = vec3(	RandomPointOnParent.x + RandomFloatInRange(-RandomScale.x, RandomScale.x), 
-									RandomPointOnParent.y + RandomFloatInRange(-RandomScale.y, RandomScale.y), 
-									RandomPointOnParent.z + RandomFloatInRange(-RandomScale.z, RandomScale.z));
-	
-
-	/// Set the axis that we determined as the normal to be maxed out
-	switch (RandAxis)
-	{
-	case(0):
-		RandomRelativePosition.z = (ParentPart->mScale.z + RandomScale.z) * RandomPointOnParent.z/abs(RandomPointOnParent.z);
-		break;
-	case(1):
-		RandomRelativePosition.y = (ParentPart->mScale.y + RandomScale.y) * RandomPointOnParent.y/abs(RandomPointOnParent.y);
-		break;
-	case(2):
-		RandomRelativePosition.x = (ParentPart->mScale.x + RandomScale.x) * RandomPointOnParent.x/abs(RandomPointOnParent.x);
-		break;
-	}
-
-	return { BoundingBox(mShapes[ParentPart].GetPosition() + RandomRelativePosition, RandomScale), ParentPart };
+	return mParts[0];
 }
 
-void Creature::AddRandomPart(physx::PxPhysics* Physics, physx::PxMaterial* PhysicsMaterial, physx::PxShapeFlags ShapeFlags, GraphicsNode Node)
+void Creature::GetBoundingBoxTransforms(std::vector<mat4>& Out) const
 {
-	CreaturePart* ParentPart;
-
-	vec3 RandomPointOnParent;
-	vec3 RandomScale;
-	vec3 RandomRelativePosition;
-
-	int TEST_TRIES = 0;
-
-	do
+	for (int i = 0; i < mGenome.mBoxes.Size(); i++)
 	{
-		ParentPart = GetRandomPart();
-		RandomPointOnParent = ParentPart->mScale;
-
-		/// Pick an axis to place the new shape on
-		int RandAxis = rand() % 3;
-		switch (RandAxis)
-		{
-		case(0):
-			/// Times these values by [-1 , 1] to get a random point on the parent shape
-			RandomPointOnParent.x *= RandomFloatInRange(-1, 1); 
-			RandomPointOnParent.y *= RandomFloatInRange(-1, 1);
-
-			/// Times this value by either -1 or 1 to get the maximum or minimum point
-			RandomPointOnParent.z *= (RandomInt(2) * 2) - 1;
-			break;
-		case(1):
-			RandomPointOnParent.z *= RandomFloatInRange(-1, 1); 
-			RandomPointOnParent.x *= RandomFloatInRange(-1, 1);
-
-			RandomPointOnParent.y *= (RandomInt(2) * 2) - 1;
-			break;
-		case(2):
-			RandomPointOnParent.y *= RandomFloatInRange(-1, 1); 
-			RandomPointOnParent.z *= RandomFloatInRange(-1, 1);
-
-			RandomPointOnParent.x *= (RandomInt(2) * 2) - 1;
-			break;
-		}
-
-		float MAX_SCALE = 3;
-		RandomScale = vec3(RandomFloat(MAX_SCALE), RandomFloat(MAX_SCALE), RandomFloat(MAX_SCALE));
-
-		/// Set the position to be the random point we calculated, but also add a random chance to shift it around based on the shape of the child
-		RandomRelativePosition = vec3(	RandomPointOnParent.x + RandomFloatInRange(-RandomScale.x, RandomScale.x), 
-										RandomPointOnParent.y + RandomFloatInRange(-RandomScale.y, RandomScale.y), 
-										RandomPointOnParent.z + RandomFloatInRange(-RandomScale.z, RandomScale.z));
-		
-
-		/// Set the axis that we determined as the normal to be maxed out
-		switch (RandAxis)
-		{
-		case(0):
-			RandomRelativePosition.z = (ParentPart->mScale.z + RandomScale.z) * RandomPointOnParent.z/abs(RandomPointOnParent.z);
-			break;
-		case(1):
-			RandomRelativePosition.y = (ParentPart->mScale.y + RandomScale.y) * RandomPointOnParent.y/abs(RandomPointOnParent.y);
-			break;
-		case(2):
-			RandomRelativePosition.x = (ParentPart->mScale.x + RandomScale.x) * RandomPointOnParent.x/abs(RandomPointOnParent.x);
-			break;
-		}
-
-		TEST_TRIES++;
-	} while (IsColliding(BoundingBox(mShapes[ParentPart].GetPosition() + RandomRelativePosition, RandomScale), ParentPart));
-	if (TEST_TRIES > 1)
-		std::cout << "It took " << TEST_TRIES << " tries to generate part!\n";
-
-	float MaxJointVel = RandomFloatInRange(-20, 20);
-	float JointOscillationSpeed = RandomFloat(10);
-	physx::PxArticulationAxis::Enum JointAxis = static_cast<physx::PxArticulationAxis::Enum>(RandomInt(3));
-
-	physx::PxArticulationDrive posDrive;
-	posDrive.stiffness = RandomInt(100);
-	posDrive.damping = RandomInt(10);
-	posDrive.maxForce = RandomInt(10);
-	posDrive.driveType = physx::PxArticulationDriveType::eACCELERATION;
-
-	physx::PxArticulationMotion::Enum JointMotion = (physx::PxArticulationMotion::Enum)RandomInt(3);
-
-	physx::PxArticulationLimit JointLimit;
-	JointLimit.low = -RandomFloat(3.14);
-	JointLimit.high = RandomFloat(3.14);
-
-	CreaturePart* NewPart = ParentPart->AddChild(Physics, mArticulation, PhysicsMaterial, ShapeFlags, Node, RandomScale, RandomRelativePosition, RandomPointOnParent, 
-										MaxJointVel, JointOscillationSpeed, JointAxis, posDrive, JointMotion, JointLimit);
-	mShapes.emplace(NewPart, BoundingBox(mShapes[ParentPart].GetPosition() + RandomRelativePosition, RandomScale));
+		BoundingBox Shape = mGenome.mBoxes.Get(i);
+		Out.push_back(translate(Shape.GetPosition()) * scale(Shape.GetScale()));
+	}
 }
 
 void Creature::SetPosition(vec3 Position)
@@ -282,353 +87,93 @@ void Creature::ClearForceAndTorque()
 	mArticulation->setRootAngularVelocity({ 0, 0, 0 });
 	mArticulation->setRootLinearVelocity({ 0, 0, 0 });
 
-	std::vector<CreaturePart*> Parts = GetAllParts();
-	for (auto& Part : Parts)
+	for (auto& Part : mParts)
 	{
-		Part->mLink->clearForce();
-		Part->mLink->clearTorque();
+		Part.mLink->clearForce();
+		Part.mLink->clearTorque();
 	}
 }
 
 void Creature::AddToScene(physx::PxScene* Scene)
 {
 	Scene->addArticulation(*mArticulation);
+
+	/// The cache and the degree of freedom layout can only be had once the articulation is in a scene
+	mCache = mArticulation->createCache();
+
+	for (JointController& Controller : mJointControllers)
+	{
+		physx::PxArticulationLink* Link = mParts[Controller.mPartIndex].mLink;
+		Controller.mDofIndex = Link->getInboundJointDof() > 0 ? Link->getDofStartIndex() : -1;
+	}
 }
 
 void Creature::RemoveFromScene(physx::PxScene* Scene)
 {
-	Scene->removeArticulation(*mArticulation);
-}
+	mCache->release();
+	mCache = nullptr;
 
-void Creature::Update()
-{
-	mRootPart->Update();
+	Scene->removeArticulation(*mArticulation);
 }
 
 void Creature::Activate(float TimePassed)
 {
-	std::vector<CreaturePart*> Parts = GetAllParts();
-	for (auto& Part : Parts)
+	for (const JointController& Controller : mJointControllers)
 	{
-		/// NOTE: This check exists since the root node does not have a joint, all other parts should absolutely have joints though
-		if (Part->mJoint != nullptr)
-			Part->Activate(TimePassed);
+		if (Controller.mDofIndex >= 0)
+			mCache->jointTargetVelocities[Controller.mDofIndex] = Controller.mMaxJointVel * sin(Controller.mJointOscillationSpeed * TimePassed);
 	}
+
+	PushJointTargets();
 }
 
-void Creature::Draw(mat4 ViewProjection, std::shared_ptr<ShaderResource> Shader)
+void Creature::PushJointTargets()
 {
-	mRootPart->Draw(ViewProjection, Shader);
+	mArticulation->applyCache(*mCache, physx::PxArticulationCacheFlag::eJOINT_TARGET_VELOCITIES);
 }
 
-void Creature::EnableGravity(bool NewState)
+void Creature::PullRootState()
 {
-	std::vector<CreaturePart*> Parts = GetAllParts();
-	for (auto Part : Parts)
-	{
-		Part->mLink->setActorFlag(physx::PxActorFlag::eDISABLE_GRAVITY, !NewState);
-	}
+	mArticulation->copyInternalStateToCache(*mCache, physx::PxArticulationCacheFlag::eROOT_TRANSFORM | physx::PxArticulationCacheFlag::eROOT_VELOCITIES);
 }
 
-/// TODO: Use the bounding boxes to make sure that the mutations don't overlap anything
-Creature* Creature::GetMutatedCreature(physx::PxPhysics* Physics, float MutationChance, float MutationSeverity)
+physx::PxTransform Creature::GetRootPose() const
 {
-	float MinMutationAmount = 1 - MutationSeverity;
-	float MaxMutationAmount = 1 + MutationSeverity;
-
-	vec3 RootScale = mRootPart->mScale;
-	/// Randomize scale
-	if (RandomFloat() < MutationChance)
-	{
-		RootScale.x *= RandomFloatInRange(MinMutationAmount, MaxMutationAmount);
-		RootScale.y *= RandomFloatInRange(MinMutationAmount, MaxMutationAmount);
-		RootScale.z *= RandomFloatInRange(MinMutationAmount, MaxMutationAmount);
-	}
-
-	Creature* NewCreature = new Creature(Physics, mRootPart->mPhysicsMaterial, mRootPart->mShapeFlags, mRootPart->mNode, RootScale);
-	NewCreature->mShapes.emplace(NewCreature->mRootPart, BoundingBox(vec3(), RootScale));
-
-	std::vector<CreaturePart*> PartsToLookAt = { mRootPart };
-	std::vector<CreaturePart*> MutatedPartsToLookAt = { NewCreature->mRootPart };
-
-
-	while (PartsToLookAt.size() > 0)
-	{
-		CreaturePart* CurrentSelfPart = PartsToLookAt[0];
-		PartsToLookAt.erase(PartsToLookAt.begin());
-
-		CreaturePart* CurrentMutatedPart = MutatedPartsToLookAt[0];
-		MutatedPartsToLookAt.erase(MutatedPartsToLookAt.begin());
-
-		for (auto ChildPart : CurrentSelfPart->mChildren)
-		{
-			/// TODO: Add in random mutations for the scale, position, and jointposition
-			/// and whatever else you'd like
-
-			vec3 MutatedScale = ChildPart->mScale;
-			vec3 MutatedRelativePosition = ChildPart->mRelativePosition;
-			vec3 MutatedJointPosition = ChildPart->mJointPosition;
-			float MutatedMaxJointVel = ChildPart->mMaxJointVel;
-			float MutatedJointOscillationSpeed = ChildPart->mJointOscillationSpeed;
-			physx::PxArticulationAxis::Enum MutatedJointAxis = ChildPart->mJointAxis;
-
-			BoundingBox PartBoundingBox = mShapes[ChildPart];
-
-			/// Randomize scale
-			if (RandomFloat() < MutationChance)
-			{
-				MutatedScale.x *= RandomFloatInRange(MinMutationAmount, MaxMutationAmount);
-				MutatedScale.y *= RandomFloatInRange(MinMutationAmount, MaxMutationAmount);
-				MutatedScale.z *= RandomFloatInRange(MinMutationAmount, MaxMutationAmount);
-
-				/// This part is adjust the position of the child and the joint based on how the creature mutated scale
-				{
-					if (ChildPart->mParentNormal.x != 0)
-					{
-						MutatedRelativePosition.x = ChildPart->mParentNormal.x * (MutatedScale.x + CurrentMutatedPart->mScale.x);
-						MutatedJointPosition.x = ChildPart->mParentNormal.x * CurrentMutatedPart->mScale.x;
-					}
-					if (ChildPart->mParentNormal.y != 0)
-					{
-						MutatedRelativePosition.y = ChildPart->mParentNormal.y * (MutatedScale.y + CurrentMutatedPart->mScale.y);
-						MutatedJointPosition.y = ChildPart->mParentNormal.y * CurrentMutatedPart->mScale.y;
-					}
-					if (ChildPart->mParentNormal.z != 0)
-					{
-						MutatedRelativePosition.z = ChildPart->mParentNormal.z * (MutatedScale.z + CurrentMutatedPart->mScale.z);
-						MutatedJointPosition.z = ChildPart->mParentNormal.z * CurrentMutatedPart->mScale.z;
-					}
-				}
-			}
-
-			///// Randomize position
-			//if (RandomFloat() < MutationChance)
-			//{
-			//	MutatedRelativePosition.x *= RandomFloatInRange(MinMutationAmount, MaxMutationAmount);
-			//	MutatedRelativePosition.y *= RandomFloatInRange(MinMutationAmount, MaxMutationAmount);
-			//	MutatedRelativePosition.z *= RandomFloatInRange(MinMutationAmount, MaxMutationAmount);
-			//}
-
-			///// Randomize joint position
-			//if (RandomFloat() < MutationChance)
-			//{
-			//	MutatedJointPosition.x *= RandomFloatInRange(MinMutationAmount, MaxMutationAmount);
-			//	MutatedJointPosition.y *= RandomFloatInRange(MinMutationAmount, MaxMutationAmount);
-			//	MutatedJointPosition.z *= RandomFloatInRange(MinMutationAmount, MaxMutationAmount);
-			//}
-
-			/// Randomize joint type
-			if (RandomFloat() < MutationChance)
-			{
-				MutatedJointAxis = static_cast<physx::PxArticulationAxis::Enum>(RandomInt(3));
-			}
-
-			/// Randomize joint velocity
-			if (RandomFloat() < MutationChance)
-			{
-				MutatedMaxJointVel *= RandomFloatInRange(MinMutationAmount, MaxMutationAmount);
-			}
-
-			/// Randomize joint oscillation
-			if (RandomFloat() < MutationChance)
-			{
-				MutatedJointOscillationSpeed *= RandomFloatInRange(MinMutationAmount, MaxMutationAmount);
-			}
-
-			CreaturePart* NewPart = CurrentMutatedPart->AddChild(Physics, NewCreature->mArticulation, ChildPart->mPhysicsMaterial, ChildPart->mShapeFlags, ChildPart->mNode, MutatedScale, 
-																MutatedRelativePosition, MutatedJointPosition, MutatedMaxJointVel, MutatedJointOscillationSpeed, MutatedJointAxis, 
-																ChildPart->mJoint->getDriveParams(ChildPart->mJointAxis), ChildPart->mJoint->getMotion(ChildPart->mJointAxis), ChildPart->mJoint->getLimitParams(ChildPart->mJointAxis));
-			/// Calculate where it ought to be based on the parent part and how the shape has shifted
-			NewCreature->mShapes.emplace(NewPart, BoundingBox(NewCreature->mShapes[CurrentMutatedPart].GetPosition() + MutatedRelativePosition, MutatedScale));
-			//NewCreature->mShapes.emplace(NewPart, PartBoundingBox);
-
-			PartsToLookAt.push_back(ChildPart);
-			MutatedPartsToLookAt.push_back(NewPart);
-		}
-	}
-
-	/// Random chance to add new part
-	if (RandomFloat() < MutationChance)
-	{
-		NewCreature->AddRandomPart(Physics, NewCreature->mRootPart->mPhysicsMaterial, NewCreature->mRootPart->mShapeFlags, NewCreature->mRootPart->mNode);
-	}
-
-	/// Random chance to remove part part
-	if (RandomFloat() < MutationChance)
-	{
-		NewCreature->RemoveChildlessPart();
-	}
-
-	return NewCreature;
+	return mCache->rootLinkData->transform;
 }
 
-Creature* Creature::GetCreatureCopy(physx::PxPhysics* Physics)
+physx::PxVec3 Creature::GetRootLinearVelocity() const
 {
-	vec3 RootScale = mRootPart->mScale;
-
-	Creature* NewCreature = new Creature(Physics, mRootPart->mPhysicsMaterial, mRootPart->mShapeFlags, mRootPart->mNode, RootScale);
-	NewCreature->mShapes.emplace(NewCreature->mRootPart, BoundingBox(vec3(), RootScale));
-
-	std::vector<CreaturePart*> PartsToLookAt = { mRootPart };
-	std::vector<CreaturePart*> CopyPartsToLookAt = { NewCreature->mRootPart };
-
-
-	while (PartsToLookAt.size() > 0)
-	{
-		CreaturePart* CurrentSelfPart = PartsToLookAt[0];
-		PartsToLookAt.erase(PartsToLookAt.begin());
-
-		CreaturePart* CurrentCopyPart = CopyPartsToLookAt[0];
-		CopyPartsToLookAt.erase(CopyPartsToLookAt.begin());
-
-		for (auto ChildPart : CurrentSelfPart->mChildren)
-		{
-			vec3 CopyScale = ChildPart->mScale;
-			vec3 CopyRelativePosition = ChildPart->mRelativePosition;
-			vec3 CopyJointPosition = ChildPart->mJointPosition;
-			float CopyMaxJointVel = ChildPart->mMaxJointVel;
-			float CopyJointOscillationSpeed = ChildPart->mJointOscillationSpeed;
-			physx::PxArticulationAxis::Enum CopyJointAxis = ChildPart->mJointAxis;
-
-			CreaturePart* NewPart = CurrentCopyPart->AddChild(Physics, NewCreature->mArticulation, ChildPart->mPhysicsMaterial, ChildPart->mShapeFlags, ChildPart->mNode, CopyScale, 
-																CopyRelativePosition, CopyJointPosition, CopyMaxJointVel, CopyJointOscillationSpeed, CopyJointAxis, 
-																ChildPart->mJoint->getDriveParams(ChildPart->mJointAxis), ChildPart->mJoint->getMotion(ChildPart->mJointAxis), ChildPart->mJoint->getLimitParams(ChildPart->mJointAxis));
-			NewCreature->mShapes.emplace(NewPart, BoundingBox(mShapes[ChildPart].GetPosition(), CopyScale));
-
-			PartsToLookAt.push_back(ChildPart);
-			CopyPartsToLookAt.push_back(NewPart);
-		}
-	}
-
-	return NewCreature;
+	return mCache->rootLinkData->worldLinVel;
 }
 
-Creature* LoadCreatureFromFile(std::string FileName, physx::PxPhysics* Physics, physx::PxMaterial* PhysicsMaterial, physx::PxShapeFlags ShapeFlags, GraphicsNode Node)
+void Creature::EnableGravity(bool NewState)
 {
-	std::ifstream infile(FileName, std::ios::binary | std::ios::in);
-	infile.seekg(0, std::ios::end);
-	int length = infile.tellg();
-	infile.seekg(0, std::ios::beg);
-	char* data = new char[length];
-	infile.read(data, length);
-	infile.close();
-
-	auto InCreature = EvolvingCreature::GetCreature(data);
-
-	auto RootScaleV = InCreature->root_part()->scale();
-	vec3 RootScale(RootScaleV->x(), RootScaleV->y(), RootScaleV->z());
-
-	Creature* NewCreature = new Creature(Physics, PhysicsMaterial, ShapeFlags, Node, RootScale);
-	NewCreature->mShapes.emplace(NewCreature->mRootPart, BoundingBox(vec3(), RootScale));
-
-	std::vector<const EvolvingCreature::CreaturePart*> PartsToLookAt = { InCreature->root_part() };
-	std::vector<CreaturePart*> NewPartsToLookAt = { NewCreature->mRootPart };
-
-	while (PartsToLookAt.size() > 0)
+	for (auto& Part : mParts)
 	{
-		const EvolvingCreature::CreaturePart* CurrentPart = PartsToLookAt[0];
-		PartsToLookAt.erase(PartsToLookAt.begin());
-
-		CreaturePart* NewCurrentPart = NewPartsToLookAt[0];
-		NewPartsToLookAt.erase(NewPartsToLookAt.begin());
-
-		for (int i = 0; i < CurrentPart->children()->size(); i++)
-		{
-			auto scale = CurrentPart->children()->Get(i)->scale();
-			auto relative_position = CurrentPart->children()->Get(i)->relative_position();
-			auto joint_position = CurrentPart->children()->Get(i)->joint_position();
-
-			float max_joint_vel = CurrentPart->children()->Get(i)->max_joint_vel();
-			float joint_oscillation_speed = CurrentPart->children()->Get(i)->joint_oscillation_speed();
-
-			auto joint_axis = CurrentPart->children()->Get(i)->joint_axis();
-
-			vec3 Scale(scale->x(), scale->y(), scale->z());
-			vec3 RelativePosition(relative_position->x(), relative_position->y(), relative_position->z());
-			vec3 JointPosition(joint_position->x(), joint_position->y(), joint_position->z());
-
-			physx::PxArticulationDrive posDrive;
-			posDrive.stiffness = CurrentPart->children()->Get(i)->joint_drive_stiffness();
-			posDrive.damping = CurrentPart->children()->Get(i)->joint_drive_damping();
-			posDrive.maxForce = CurrentPart->children()->Get(i)->joint_drive_max_force();
-			posDrive.driveType = physx::PxArticulationDriveType::eACCELERATION;
-
-			physx::PxArticulationMotion::Enum JointMotion = (physx::PxArticulationMotion::Enum)CurrentPart->children()->Get(i)->joint_motion();
-			physx::PxArticulationLimit JointLimit;
-			JointLimit.low = CurrentPart->children()->Get(i)->joint_low_limit();
-			JointLimit.high = CurrentPart->children()->Get(i)->joint_high_limit();
-
-			CreaturePart* NewPart = NewCurrentPart->AddChild(Physics, NewCreature->mArticulation, PhysicsMaterial, ShapeFlags, Node, Scale, 
-																RelativePosition, JointPosition, max_joint_vel, joint_oscillation_speed, (physx::PxArticulationAxis::Enum)joint_axis, 
-																posDrive, JointMotion, JointLimit);
-
-			NewCreature->mShapes.emplace(NewPart, BoundingBox(NewCreature->mShapes[NewCurrentPart].GetPosition() + RelativePosition, Scale));
-
-			PartsToLookAt.push_back(CurrentPart->children()->Get(i));
-			NewPartsToLookAt.push_back(NewPart);
-		}
+		Part.mLink->setActorFlag(physx::PxActorFlag::eDISABLE_GRAVITY, !NewState);
 	}
-
-	delete[] data;
-
-	return NewCreature;
 }
 
-static flatbuffers::Offset<EvolvingCreature::CreaturePart> CreateFlatbufferCreaturePart(flatbuffers::FlatBufferBuilder &Builder, CreaturePart* Part)
+void Creature::SetCollisionGroup(uint32 Group)
 {
-	std::vector<flatbuffers::Offset<EvolvingCreature::CreaturePart>> CreatureParts;
+	physx::PxFilterData FilterData(0, Group, 0, 0);
 
-	for (auto Child : Part->mChildren)
+	for (auto& Part : mParts)
 	{
-		CreatureParts.push_back(CreateFlatbufferCreaturePart(Builder, Child));
+		/// Each part only has the one box shape
+		physx::PxShape* Shape = nullptr;
+		Part.mLink->getShapes(&Shape, 1);
+		Shape->setSimulationFilterData(FilterData);
 	}
+}
 
-	auto BuPartScale = EvolvingCreature::Vec3(Part->mScale.x, Part->mScale.y, Part->mScale.z);
-	auto BuPartRelativePosition = EvolvingCreature::Vec3(Part->mRelativePosition.x, Part->mRelativePosition.y, Part->mRelativePosition.z);
-	auto BuPartJointPosition = EvolvingCreature::Vec3(Part->mJointPosition.x, Part->mJointPosition.y, Part->mJointPosition.z);
-
-	float BuDriveStiffness = 0;
-	float BuDriveDamping = 0;
-	float BuDriveMaxForce = 0;
-
-	float BuJointLowLimit = 0;
-	float BuJointHighLimit = 0;
-
-	EvolvingCreature::ArticulationMotion BuJointMotion = EvolvingCreature::ArticulationMotion_eLIMITED;
-
-	/// The root node doesn't have a joint so I have to ignore that ones values
-	if (Part->mJoint != nullptr)
-	{
-		BuDriveStiffness = Part->mJoint->getDriveParams(Part->mJointAxis).stiffness;
-		BuDriveDamping = Part->mJoint->getDriveParams(Part->mJointAxis).damping;
-		BuDriveMaxForce = Part->mJoint->getDriveParams(Part->mJointAxis).maxForce;
-
-		BuJointLowLimit = Part->mJoint->getLimitParams(Part->mJointAxis).low;
-		BuJointHighLimit = Part->mJoint->getLimitParams(Part->mJointAxis).high;
-
-		BuJointMotion = (EvolvingCreature::ArticulationMotion)Part->mJoint->getMotion(Part->mJointAxis);
-	}
-
-	auto Parts = Builder.CreateVector(CreatureParts);
-	auto BuPart = EvolvingCreature::CreateCreaturePart(Builder, &BuPartScale, &BuPartRelativePosition, &BuPartJointPosition, 
-			Part->mMaxJointVel, Part->mJointOscillationSpeed, (EvolvingCreature::ArticulationAxis)Part->mJointAxis, 
-			BuJointMotion, BuJointLowLimit, BuJointHighLimit, BuDriveStiffness, BuDriveDamping, BuDriveMaxForce, Parts);
-
-	return BuPart;
+Creature* LoadCreatureFromFile(std::string FileName, physx::PxPhysics* Physics, physx::PxMaterial* PhysicsMaterial, physx::PxShapeFlags ShapeFlags)
+{
+	return new Creature(LoadGenomeFromFile(FileName), Physics, PhysicsMaterial, ShapeFlags);
 }
 
 void SaveCreatureToFile(Creature* CreatureToSave, std::string FileName)
 {
-	flatbuffers::FlatBufferBuilder builder(1024);
-
-	auto RootPart = CreateFlatbufferCreaturePart(builder, CreatureToSave->mRootPart);
-	auto Creature = EvolvingCreature::CreateCreature(builder, RootPart);
-
-	builder.Finish(Creature);
-
-	/// Write the buffer to a file
-	std::ofstream ofile(FileName, std::ios::binary);
-	assert(ofile.is_open());
-	ofile.write((char*)builder.GetBufferPointer(), builder.GetSize());
-	ofile.close();
+	SaveGenomeToFile(CreatureToSave->mGenome, FileName);
 }
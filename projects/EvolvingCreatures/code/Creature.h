@@ -3,45 +3,64 @@
 #include "config.h"
 #include <physx/PxPhysicsAPI.h>
 #include "CreaturePart.h"
-#include "BoundingBox.h"
+#include "CreatureGenome.h"
+
+/// Everything the controller touches for one joint, packed together so Activate walks a small contiguous array
+struct JointController
+{
+	/// Where the joint's degree of freedom is in the arrays of the articulation cache, only known once the creature is in a scene.
+	/// Locked joints have no degree of freedom and are left at -1
+	int mDofIndex;
+	int mPartIndex;
+	float mMaxJointVel;
+	float mJointOscillationSpeed;
+};
 
 class Creature
 {
 public:
 	physx::PxArticulationReducedCoordinate* mArticulation;
-	CreaturePart* mRootPart;
-	std::map<CreaturePart*, BoundingBox> mShapes;
+	/// Every part of the creature in one array, in the same topological order as the genome so mGenome.mParts[i] is the gene for mParts[i].
+	/// The root is at index 0 and is the only part without a joint
+	std::vector<CreaturePart> mParts;
+	/// One entry per jointed part, built once with the creature and used every step by Activate
+	std::vector<JointController> mJointControllers;
+	/// Used to push every joint target and pull the root state in one call each per step, only exists while the creature is in a scene
+	physx::PxArticulationCache* mCache = nullptr;
+	/// The genome this creature was built from, anything that breeds or saves the creature should work on this
+	CreatureGenome mGenome;
+	/// Unique for every creature made during a run, unlike the address it is never reused once the creature is deleted
+	uint64_t mId;
 	
-	Creature(physx::PxPhysics* Physics, physx::PxMaterial* PhysicsMaterial, physx::PxShapeFlags ShapeFlags, GraphicsNode Node, vec3 Scale);
+	/// Builds the articulation described by the genome, this is the only place PhysX objects are created for a creature
+	Creature(const CreatureGenome& Genome, physx::PxPhysics* Physics, physx::PxMaterial* PhysicsMaterial, physx::PxShapeFlags ShapeFlags);
 	~Creature();
 
-	CreaturePart* GetChildlessPart() const;
-	void RemoveChildlessPart();
-	CreaturePart* GetRandomPart();
-	std::vector<CreaturePart*> GetAllParts();
-	std::vector<CreaturePart*> GetAllPartsFrom(CreaturePart* Part);
-	void DrawBoundingBoxes(mat4 ViewProjection, vec3 Position, GraphicsNode Node);
-	bool IsColliding(BoundingBox Box, CreaturePart* ToIgnore = nullptr);
+	CreaturePart& GetRootPart();
+	/// Appends the transform of every box in the genome, relative to where the creature spawns
+	void GetBoundingBoxTransforms(std::vector<mat4>& Out) const;
 
-	std::pair<BoundingBox, CreaturePart*> GetRandomShape();
-	void AddRandomPart(physx::PxPhysics* Physics, physx::PxMaterial* PhysicsMaterial, physx::PxShapeFlags ShapeFlags, GraphicsNode Node);
 	void SetPosition(vec3 Position);
 	void ClearForceAndTorque();
 
 	void AddToScene(physx::PxScene* Scene);
 	void RemoveFromScene(physx::PxScene* Scene);
 
-	void Update();
 	void Activate(float TimePassed);
-	void Draw(mat4 ViewProjection, std::shared_ptr<ShaderResource> Shader = nullptr);
+
+	/// Sends the joint target velocities that were written into mCache->jointTargetVelocities to the articulation
+	void PushJointTargets();
+	/// Reads the pose and velocity of the root link into mCache, GetRootPose and GetRootLinearVelocity return what was read last
+	void PullRootState();
+	physx::PxTransform GetRootPose() const;
+	physx::PxVec3 GetRootLinearVelocity() const;
 
 	void EnableGravity(bool NewState);
 
-	/// Mutation chance is a float from 0 to 1 that represents how likely a mutation is per randomization chance
-	Creature* GetMutatedCreature(physx::PxPhysics* Physics, float MutationChance, float MutationSeverity);
-	Creature* GetCreatureCopy(physx::PxPhysics* Physics);
+	/// Puts the id in word1 of the simulation filter data of every shape, creatures with different ids don't collide in a shared scene
+	void SetCollisionGroup(uint32 Group);
 };
 
 /// TODO: Implement these features so that interesting creatures can be saved for later
-Creature* LoadCreatureFromFile(std::string FileName, physx::PxPhysics* Physics, physx::PxMaterial* PhysicsMaterial, physx::PxShapeFlags ShapeFlags, GraphicsNode Node);
+Creature* LoadCreatureFromFile(std::string FileName, physx::PxPhysics* Physics, physx::PxMaterial* PhysicsMaterial, physx::PxShapeFlags ShapeFlags);
 void SaveCreatureToFile(Creature* CreatureToSave, std::string FileName);
@@ -0,0 +1,418 @@
+#include "CreatureGenome.h"
+#include "RandomUtils.h"
+#include "flatbuffers/flatbuffers.h"
+#include "Creature_generated.h"
+#include <fstream>
+#include <iostream>
+
+CreatureGenome::CreatureGenome()
+{
+	/// Intentionally left blank
+}
+
+CreatureGenome::CreatureGenome(vec3 RootScale)
+{
+	PartGene Root;
+	Root.mScale = RootScale;
+	mParts.push_back(Root);
+	mBoxes.Add(BoundingBox(vec3(), RootScale));
+}
+
+int CreatureGenome::GetRandomPartIndex() const
+{
+	return RandomInt(mParts.size());
+}
+
+int CreatureGenome::GetChildlessPartIndex() const
+{
+	int CurrentPart = 0;
+	std::vector<int> Children = GetChildren(CurrentPart);
+
+	while (Children.size() > 0)
+	{
+		CurrentPart = Children[RandomInt(Children.size())];
+		Children = GetChildren(CurrentPart);
+	}
+
+	return CurrentPart;
+}
+
+std::vector<int> CreatureGenome::GetChildren(int PartIndex) const
+{
+	std::vector<int> Children;
+
+	/// Children always come after their parent so there's no need to look at anything before it
+	for (int i = PartIndex + 1; i < mParts.size(); i++)
+	{
+		if (mParts[i].mParentIndex == PartIndex)
+			Children.push_back(i);
+	}
+
+	return Children;
+}
+
+void CreatureGenome::AddPart(PartGene Part)
+{
+	assert(Part.mParentIndex >= 0 && Part.mParentIndex < mParts.size());
+
+	const PartGene& Parent = mParts[Part.mParentIndex];
+
+	/// The joint sits on one of the faces of the parent, the normal of that face is the axis where the joint position is maxed out
+	{
+		float xVal = 0;
+		float yVal = 0;
+		float zVal = 0;
+
+		if (Part.mJointPosition.x != 0)
+			xVal = (Part.mJointPosition.x / abs(Part.mJointPosition.x)) * (abs(Part.mJointPosition.x) == Parent.mScale.x);
+		if (Part.mJointPosition.y != 0)
+			yVal = (Part.mJointPosition.y / abs(Part.mJointPosition.y)) * (abs(Part.mJointPosition.y) == Parent.mScale.y);
+		if (Part.mJointPosition.z != 0)
+			zVal = (Part.mJointPosition.z / abs(Part.mJointPosition.z)) * (abs(Part.mJointPosition.z) == Parent.mScale.z);
+
+		Part.mParentNormal = vec3(xVal, yVal, zVal);
+	}
+
+	mBoxes.Add(BoundingBox(mBoxes.Get(Part.mParentIndex).GetPosition() + Part.mRelativePosition, Part.mScale));
+	mParts.push_back(Part);
+}
+
+void CreatureGenome::AddRandomPart()
+{
+	int ParentIndex;
+
+	vec3 RandomPointOnParent;
+	vec3 RandomScale;
+	vec3 RandomRelativePosition;
+
+	do
+	{
+		ParentIndex = GetRandomPartIndex();
+		RandomPointOnParent = mParts[ParentIndex].mScale;
+
+		/// Pick an axis to place the new shape on
+		int RandAxis = RandomInt(3);
+		switch (RandAxis)
+		{
+		case(0):
+			/// Times these values by [-1 , 1] to get a random point on the parent shape
+			RandomPointOnParent.x *= RandomFloatInRange(-1, 1);
+			RandomPointOnParent.y *= RandomFloatInRange(-1, 1);
+
+			/// Times this value by either -1 or 1 to get the maximum or minimum point
+			RandomPointOnParent.z *= (RandomInt(2) * 2) - 1;
+			break;
+		case(1):
+			RandomPointOnParent.z *= RandomFloatInRange(-1, 1);
+			RandomPointOnParent.x *= RandomFloatInRange(-1, 1);
+
+			RandomPointOnParent.y *= (RandomInt(2) * 2) - 1;
+			break;
+		case(2):
+			RandomPointOnParent.y *= RandomFloatInRange(-1, 1);
+			RandomPointOnParent.z *= RandomFloatInRange(-1, 1);
+
+			RandomPointOnParent.x *= (RandomInt(2) * 2) - 1;
+			break;
+		}
+
+		float MAX_SCALE = 3;
+		RandomScale = vec3(RandomFloat(MAX_SCALE), RandomFloat(MAX_SCALE), RandomFloat(MAX_SCALE));
+
+		/// Set the position to be the random point we calculated, but also add a random chance to shift it around based on the shape of the child
+		RandomRelativePosition = vec3(	RandomPointOnParent.x + RandomFloatInRange(-RandomScale.x, RandomScale.x),
+										RandomPointOnParent.y + RandomFloatInRange(-RandomScale.y, RandomScale.y),
+										RandomPointOnParent.z + RandomFloatInRange(-RandomScale.z, RandomScale.z));
+
+
+		/// Set the axis that we determined as the normal to be maxed out
+		switch (RandAxis)
+		{
+		case(0):
+			RandomRelativePosition.z = (mParts[ParentIndex].mScale.z + RandomScale.z) * RandomPointOnParent.z/abs(RandomPointOnParent.z);
+			break;
+		case(1):
+			RandomRelativePosition.y = (mParts[ParentIndex].mScale.y + RandomScale.y) * RandomPointOnParent.y/abs(RandomPointOnParent.y);
+			break;
+		case(2):
+			RandomRelativePosition.x = (mParts[ParentIndex].mScale.x + RandomScale.x) * RandomPointOnParent.x/abs(RandomPointOnParent.x);
+			break;
+		}
+	} while (IsColliding(BoundingBox(mBoxes.Get(ParentIndex).GetPosition() + RandomRelativePosition, RandomScale), ParentIndex));
+
+	PartGene NewPart;
+	NewPart.mParentIndex = ParentIndex;
+	NewPart.mScale = RandomScale;
+	NewPart.mRelativePosition = RandomRelativePosition;
+	NewPart.mJointPosition = RandomPointOnParent;
+
+	NewPart.mMaxJointVel = RandomFloatInRange(-20, 20);
+	NewPart.mJointOscillationSpeed = RandomFloat(10);
+	NewPart.mJointAxis = static_cast<GeneJointAxis>(RandomInt(3));
+
+	NewPart.mDriveStiffness = RandomInt(100);
+	NewPart.mDriveDamping = RandomInt(10);
+	NewPart.mDriveMaxForce = RandomInt(10);
+
+	NewPart.mJointMotion = static_cast<GeneJointMotion>(RandomInt(3));
+	NewPart.mJointLowLimit = -RandomFloat(3.14);
+	NewPart.mJointHighLimit = RandomFloat(3.14);
+
+	AddPart(NewPart);
+}
+
+void CreatureGenome::RemoveChildlessPart()
+{
+	int PartIndex = GetChildlessPartIndex();
+
+	if (PartIndex == 0)
+	{
+		std::cout << "NOTE: Invoked CreatureGenome::RemoveChildlessPart() on a creature with no children\n";
+		return;
+	}
+
+	mParts.erase(mParts.begin() + PartIndex);
+	mBoxes.Remove(PartIndex);
+
+	/// Everything after the removed part shifted down by one, so the parent indices pointing past it have to as well
+	for (auto& Part : mParts)
+	{
+		if (Part.mParentIndex > PartIndex)
+			Part.mParentIndex--;
+	}
+}
+
+bool CreatureGenome::IsColliding(BoundingBox Box, int ToIgnore) const
+{
+	return mBoxes.IsColliding(Box, ToIgnore);
+}
+
+/// TODO: Use the bounding boxes to make sure that the mutations don't overlap anything
+CreatureGenome CreatureGenome::GetMutated(float MutationChance, float MutationSeverity) const
+{
+	float MinMutationAmount = 1 - MutationSeverity;
+	float MaxMutationAmount = 1 + MutationSeverity;
+
+	vec3 RootScale = mParts[0].mScale;
+	/// Randomize scale
+	if (RandomFloat() < MutationChance)
+	{
+		RootScale.x *= RandomFloatInRange(MinMutationAmount, MaxMutationAmount);
+		RootScale.y *= RandomFloatInRange(MinMutationAmount, MaxMutationAmount);
+		RootScale.z *= RandomFloatInRange(MinMutationAmount, MaxMutationAmount);
+	}
+
+	CreatureGenome NewGenome(RootScale);
+
+	/// Parents always come before their children, so the parent has already been mutated by the time we get to the child
+	for (int i = 1; i < mParts.size(); i++)
+	{
+		PartGene MutatedPart = mParts[i];
+		const PartGene& MutatedParent = NewGenome.mParts[MutatedPart.mParentIndex];
+
+		/// Randomize scale
+		if (RandomFloat() < MutationChance)
+		{
+			MutatedPart.mScale.x *= RandomFloatInRange(MinMutationAmount, MaxMutationAmount);
+			MutatedPart.mScale.y *= RandomFloatInRange(MinMutationAmount, MaxMutationAmount);
+			MutatedPart.mScale.z *= RandomFloatInRange(MinMutationAmount, MaxMutationAmount);
+
+			/// This part is adjust the position of the child and the joint based on how the creature mutated scale
+			{
+				if (MutatedPart.mParentNormal.x != 0)
+				{
+					MutatedPart.mRelativePosition.x = MutatedPart.mParentNormal.x * (MutatedPart.mScale.x + MutatedParent.mScale.x);
+					MutatedPart.mJointPosition.x = MutatedPart.mParentNormal.x * MutatedParent.mScale.x;
+				}
+				if (MutatedPart.mParentNormal.y != 0)
+				{
+					MutatedPart.mRelativePosition.y = MutatedPart.mParentNormal.y * (MutatedPart.mScale.y + MutatedParent.mScale.y);
+					MutatedPart.mJointPosition.y = MutatedPart.mParentNormal.y * MutatedParent.mScale.y;
+				}
+				if (MutatedPart.mParentNormal.z != 0)
+				{
+					MutatedPart.mRelativePosition.z = MutatedPart.mParentNormal.z * (MutatedPart.mScale.z + MutatedParent.mScale.z);
+					MutatedPart.mJointPosition.z = MutatedPart.mParentNormal.z * MutatedParent.mScale.z;
+				}
+			}
+		}
+
+		/// Randomize joint type
+		if (RandomFloat() < MutationChance)
+		{
+			MutatedPart.mJointAxis = static_cast<GeneJointAxis>(RandomInt(3));
+		}
+
+		/// Randomize joint velocity
+		if (RandomFloat() < MutationChance)
+		{
+			MutatedPart.mMaxJointVel *= RandomFloatInRange(MinMutationAmount, MaxMutationAmount);
+		}
+
+		/// Randomize joint oscillation
+		if (RandomFloat() < MutationChance)
+		{
+			MutatedPart.mJointOscillationSpeed *= RandomFloatInRange(MinMutationAmount, MaxMutationAmount);
+		}
+
+		/// Calculate where it ought to be based on the parent part and how the shape has shifted
+		NewGenome.AddPart(MutatedPart);
+	}
+
+	/// Random chance to add new part
+	if (RandomFloat() < MutationChance)
+	{
+		NewGenome.AddRandomPart();
+	}
+
+	/// Random chance to remove part part
+	if (RandomFloat() < MutationChance)
+	{
+		NewGenome.RemoveChildlessPart();
+	}
+
+	return NewGenome;
+}
+
+/// FNV-1a, fed one value at a time so padding in the structs never ends up in the hash
+static void HashBytes(uint64_t& Hash, const void* Data, size_t Size)
+{
+	const uint8_t* Bytes = (const uint8_t*)Data;
+	for (size_t i = 0; i < Size; i++)
+	{
+		Hash ^= Bytes[i];
+		Hash *= 0x100000001b3ULL;
+	}
+}
+
+static void HashVec3(uint64_t& Hash, const vec3& Value)
+{
+	HashBytes(Hash, &Value.x, sizeof(float));
+	HashBytes(Hash, &Value.y, sizeof(float));
+	HashBytes(Hash, &Value.z, sizeof(float));
+}
+
+uint64_t CreatureGenome::GetHash() const
+{
+	uint64_t Hash = 0xcbf29ce484222325ULL;
+
+	/// The parent normal and the bounding boxes are worked out from the rest, so they don't need to be part of it
+	for (const PartGene& Part : mParts)
+	{
+		HashBytes(Hash, &Part.mParentIndex, sizeof(Part.mParentIndex));
+		HashVec3(Hash, Part.mScale);
+		HashVec3(Hash, Part.mRelativePosition);
+		HashVec3(Hash, Part.mJointPosition);
+		HashBytes(Hash, &Part.mMaxJointVel, sizeof(Part.mMaxJointVel));
+		HashBytes(Hash, &Part.mJointOscillationSpeed, sizeof(Part.mJointOscillationSpeed));
+		HashBytes(Hash, &Part.mJointAxis, sizeof(Part.mJointAxis));
+		HashBytes(Hash, &Part.mJointMotion, sizeof(Part.mJointMotion));
+		HashBytes(Hash, &Part.mJointLowLimit, sizeof(Part.mJointLowLimit));
+		HashBytes(Hash, &Part.mJointHighLimit, sizeof(Part.mJointHighLimit));
+		HashBytes(Hash, &Part.mDriveStiffness, sizeof(Part.mDriveStiffness));
+		HashBytes(Hash, &Part.mDriveDamping, sizeof(Part.mDriveDamping));
+		HashBytes(Hash, &Part.mDriveMaxForce, sizeof(Part.mDriveMaxForce));
+	}
+
+	return Hash;
+}
+
+CreatureGenome LoadGenomeFromFile(std::string FileName)
+{
+	std::ifstream infile(FileName, std::ios::binary | std::ios::in);
+	infile.seekg(0, std::ios::end);
+	int length = infile.tellg();
+	infile.seekg(0, std::ios::beg);
+	char* data = new char[length];
+	infile.read(data, length);
+	infile.close();
+
+	auto InCreature = EvolvingCreature::GetCreature(data);
+
+	auto RootScaleV = InCreature->root_part()->scale();
+	CreatureGenome NewGenome(vec3(RootScaleV->x(), RootScaleV->y(), RootScaleV->z()));
+
+	std::vector<const EvolvingCreature::CreaturePart*> PartsToLookAt = { InCreature->root_part() };
+	std::vector<int> PartIndicesToLookAt = { 0 };
+
+	while (PartsToLookAt.size() > 0)
+	{
+		const EvolvingCreature::CreaturePart* CurrentPart = PartsToLookAt[0];
+		PartsToLookAt.erase(PartsToLookAt.begin());
+
+		int CurrentPartIndex = PartIndicesToLookAt[0];
+		PartIndicesToLookAt.erase(PartIndicesToLookAt.begin());
+
+		for (int i = 0; i < CurrentPart->children()->size(); i++)
+		{
+			auto InPart = CurrentPart->children()->Get(i);
+
+			PartGene NewPart;
+			NewPart.mParentIndex = CurrentPartIndex;
+			NewPart.mScale = vec3(InPart->scale()->x(), InPart->scale()->y(), InPart->scale()->z());
+			NewPart.mRelativePosition = vec3(InPart->relative_position()->x(), InPart->relative_position()->y(), InPart->relative_position()->z());
+			NewPart.mJointPosition = vec3(InPart->joint_position()->x(), InPart->joint_position()->y(), InPart->joint_position()->z());
+
+			NewPart.mMaxJointVel = InPart->max_joint_vel();
+			NewPart.mJointOscillationSpeed = InPart->joint_oscillation_speed();
+			NewPart.mJointAxis = (GeneJointAxis)InPart->joint_axis();
+
+			NewPart.mDriveStiffness = InPart->joint_drive_stiffness();
+			NewPart.mDriveDamping = InPart->joint_drive_damping();
+			NewPart.mDriveMaxForce = InPart->joint_drive_max_force();
+
+			NewPart.mJointMotion = (GeneJointMotion)InPart->joint_motion();
+			NewPart.mJointLowLimit = InPart->joint_low_limit();
+			NewPart.mJointHighLimit = InPart->joint_high_limit();
+
+			NewGenome.AddPart(NewPart);
+
+			PartsToLookAt.push_back(InPart);
+			PartIndicesToLookAt.push_back(NewGenome.mParts.size() - 1);
+		}
+	}
+
+	delete[] data;
+
+	return NewGenome;
+}
+
+static flatbuffers::Offset<EvolvingCreature::CreaturePart> CreateFlatbufferCreaturePart(flatbuffers::FlatBufferBuilder &Builder, const CreatureGenome& Genome, int PartIndex)
+{
+	std::vector<flatbuffers::Offset<EvolvingCreature::CreaturePart>> CreatureParts;
+
+	for (int Child : Genome.GetChildren(PartIndex))
+	{
+		CreatureParts.push_back(CreateFlatbufferCreaturePart(Builder, Genome, Child));
+	}
+
+	const PartGene& Part = Genome.mParts[PartIndex];
+
+	auto BuPartScale = EvolvingCreature::Vec3(Part.mScale.x, Part.mScale.y, Part.mScale.z);
+	auto BuPartRelativePosition = EvolvingCreature::Vec3(Part.mRelativePosition.x, Part.mRelativePosition.y, Part.mRelativePosition.z);
+	auto BuPartJointPosition = EvolvingCreature::Vec3(Part.mJointPosition.x, Part.mJointPosition.y, Part.mJointPosition.z);
+
+	auto Parts = Builder.CreateVector(CreatureParts);
+	auto BuPart = EvolvingCreature::CreateCreaturePart(Builder, &BuPartScale, &BuPartRelativePosition, &BuPartJointPosition,
+			Part.mMaxJointVel, Part.mJointOscillationSpeed, (EvolvingCreature::ArticulationAxis)Part.mJointAxis,
+			(EvolvingCreature::ArticulationMotion)Part.mJointMotion, Part.mJointLowLimit, Part.mJointHighLimit,
+			Part.mDriveStiffness, Part.mDriveDamping, Part.mDriveMaxForce, Parts);
+
+	return BuPart;
+}
+
+void SaveGenomeToFile(const CreatureGenome& Genome, std::string FileName)
+{
+	flatbuffers::FlatBufferBuilder builder(1024);
+
+	auto RootPart = CreateFlatbufferCreaturePart(builder, Genome, 0);
+	auto Creature = EvolvingCreature::CreateCreature(builder, RootPart);
+
+	builder.Finish(Creature);
+
+	/// Write the buffer to a file
+	std::ofstream ofile(FileName, std::ios::binary);
+	assert(ofile.is_open());
+	ofile.write((char*)builder.GetBufferPointer(), builder.GetSize());
+	ofile.close();
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "config.h"
+#include "core/math/vec3.h"
+#include "BoundingBox.h"
+#include <vector>
+#include <string>
+
+/// Same values as physx::PxArticulationAxis::Enum, the genome keeps its own copy so it doesn't depend on PhysX
+enum class GeneJointAxis : int8
+{
+	eTWIST = 0,
+	eSWING1 = 1,
+	eSWING2 = 2,
+};
+
+/// Same values as physx::PxArticulationMotion::Enum
+enum class GeneJointMotion : int8
+{
+	eLOCKED = 0,
+	eLIMITED = 1,
+	eFREE = 2,
+};
+
+/// Everything needed to build a single body part, the root part has no parent and its joint values are ignored
+struct PartGene
+{
+	int mParentIndex = -1;
+
+	vec3 mScale;
+	vec3 mRelativePosition;
+	vec3 mJointPosition;
+	/// Which face of the parent the part is attached to, used to keep it attached when the scale mutates
+	vec3 mParentNormal;
+
+	/// These values are for the activation
+	float mMaxJointVel = 0;
+	float mJointOscillationSpeed = 0;
+
+	GeneJointAxis mJointAxis = GeneJointAxis::eTWIST;
+	GeneJointMotion mJointMotion = GeneJointMotion::eLIMITED;
+	float mJointLowLimit = 0;
+	float mJointHighLimit = 0;
+
+	float mDriveStiffness = 0;
+	float mDriveDamping = 0;
+	float mDriveMaxForce = 0;
+};
+
+/// The genotype of a creature, plain data with no PhysX objects so it is cheap to copy, mutate and save.
+/// A Creature is built from one of these when it is going to be simulated.
+class CreatureGenome
+{
+public:
+	/// Stored in topological order, the root is at index 0 and every part comes after its parent
+	std::vector<PartGene> mParts;
+	/// The bounding box of each part relative to the root, parallel to mParts
+	BoundingBoxSet mBoxes;
+
+	CreatureGenome();
+	CreatureGenome(vec3 RootScale);
+
+	int GetRandomPartIndex() const;
+	int GetChildlessPartIndex() const;
+	std::vector<int> GetChildren(int PartIndex) const;
+
+	/// Appends the part and works out its parent normal and bounding box, the parent must already be in the genome
+	void AddPart(PartGene Part);
+	void AddRandomPart();
+	void RemoveChildlessPart();
+	bool IsColliding(BoundingBox Box, int ToIgnore = -1) const;
+
+	/// Mutation chance is a float from 0 to 1 that represents how likely a mutation is per randomization chance
+	CreatureGenome GetMutated(float MutationChance, float MutationSeverity) const;
+
+	/// Hash of every value in the genes, genomes that are the same down to the bit always hash the same
+	uint64_t GetHash() const;
+};
+
+CreatureGenome LoadGenomeFromFile(std::string FileName);
+void SaveGenomeToFile(const CreatureGenome& Genome, std::string FileName);
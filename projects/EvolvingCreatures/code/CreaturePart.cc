@@ -1,5 +1,6 @@
 #include "CreaturePart.h"
 #include "RandomUtils.h"
+#include <cmath>
 
 CreaturePart::CreaturePart(physx::PxMaterial* PhysicsMaterial, physx::PxShapeFlags ShapeFlags, float MaxJointVel, float JointOscillationSpeed) : 
 	mPhysicsMaterial(PhysicsMaterial), 
@@ -10,59 +11,27 @@ CreaturePart::CreaturePart(physx::PxMaterial* PhysicsMaterial, physx::PxShapeFla
 	/// Intentionally left blank
 }
 
-CreaturePart::~CreaturePart()
-{
-	for (auto& Child : mChildren)
-	{
-		delete Child;
-	}
-	mLink->release();
-}
-
-void CreaturePart::AddBoxShape(physx::PxPhysics* Physics, vec3 Scale, GraphicsNode Node)
+void CreaturePart::AddBoxShape(physx::PxPhysics* Physics, vec3 Scale)
 {
 	physx::PxShape* shape = Physics->createShape(physx::PxBoxGeometry({Scale.x, Scale.y, Scale.z}), &mPhysicsMaterial, 1, true, mShapeFlags);
 	mLink->attachShape(*shape);
 	shape->release();
 	mScale = Scale;
-	mNode = Node;
 }
 
-CreaturePart* CreaturePart::AddChild(physx::PxPhysics* Physics, physx::PxArticulationReducedCoordinate* Articulation, physx::PxMaterial* PhysicsMaterial, 
-	physx::PxShapeFlags ShapeFlags, GraphicsNode Node, vec3 Scale, vec3 RelativePosition, vec3 JointPosition, float MaxJointVel, float JointOscillationSpeed, 
+CreaturePart CreaturePart::CreateChild(physx::PxPhysics* Physics, physx::PxArticulationReducedCoordinate* Articulation, physx::PxMaterial* PhysicsMaterial, 
+	physx::PxShapeFlags ShapeFlags, vec3 Scale, vec3 RelativePosition, vec3 JointPosition, float MaxJointVel, float JointOscillationSpeed, 
 	physx::PxArticulationAxis::Enum JointAxis, physx::PxArticulationDrive PosDrive, physx::PxArticulationMotion::Enum JointMotion, physx::PxArticulationLimit JointLimit)
 {
-	CreaturePart* NewPart = new CreaturePart(PhysicsMaterial, ShapeFlags, MaxJointVel, JointOscillationSpeed);
-	NewPart->mLink = Articulation->createLink(mLink, physx::PxTransform(physx::PxIdentity));
-	NewPart->AddBoxShape(Physics, Scale, Node);
-
-	NewPart->mJoint = NewPart->mLink->getInboundJoint();
-	NewPart->mJoint->setParentPose(physx::PxTransform({JointPosition.x, JointPosition.y, JointPosition.z}));
-	NewPart->mJoint->setChildPose(physx::PxTransform({JointPosition.x - RelativePosition.x, JointPosition.y - RelativePosition.y, JointPosition.z - RelativePosition.z}));
-
-	/// Set these values so we can fetch them when we mutate the creature
-	NewPart->mJointPosition = JointPosition;
-	NewPart->mRelativePosition = RelativePosition;
-
-	/// All this so that I don't have to pass an extra variable
-	{
-		float xVal = 0;
-		float yVal = 0;
-		float zVal = 0;
+	CreaturePart NewPart(PhysicsMaterial, ShapeFlags, MaxJointVel, JointOscillationSpeed);
+	NewPart.mLink = Articulation->createLink(mLink, physx::PxTransform(physx::PxIdentity));
+	NewPart.AddBoxShape(Physics, Scale);
 
-		if (JointPosition.x != 0)
-			xVal = (JointPosition.x / abs(JointPosition.x)) * (abs(JointPosition.x) == mScale.x);
-		if (JointPosition.y != 0)
-			yVal = (JointPosition.y / abs(JointPosition.y)) * (abs(JointPosition.y) == mScale.y);
-		if (JointPosition.z != 0)
-			zVal = (JointPosition.z / abs(JointPosition.z)) * (abs(JointPosition.z) == mScale.z);
+	NewPart.mJoint = NewPart.mLink->getInboundJoint();
+	NewPart.mJoint->setParentPose(physx::PxTransform({JointPosition.x, JointPosition.y, JointPosition.z}));
+	NewPart.mJoint->setChildPose(physx::PxTransform({JointPosition.x - RelativePosition.x, JointPosition.y - RelativePosition.y, JointPosition.z - RelativePosition.z}));
 
-		NewPart->mParentNormal = vec3(xVal, yVal, zVal);
-	}
-
-	NewPart->ConfigureJoint(JointAxis, JointMotion, JointLimit, PosDrive);
-	
-	mChildren.push_back(NewPart);
+	NewPart.ConfigureJoint(JointAxis, JointMotion, JointLimit, PosDrive);
 
 	return NewPart;
 }
@@ -86,35 +55,28 @@ void CreaturePart::ConfigureJoint(physx::PxArticulationAxis::Enum JointAxis, phy
 	mJoint->setDriveParams(mJointAxis, PosDrive);
 }
 
-void CreaturePart::Activate(float TimePassed)
-{
-	mJoint->setDriveVelocity(mJointAxis, mMaxJointVel * sin(mJointOscillationSpeed * TimePassed));
-}
-
-void CreaturePart::Update()
+mat4 CreaturePart::MakeTransform(const physx::PxTransform& Pose, vec3 Scale)
 {
-	physx::PxVec3 Pos = mLink->getGlobalPose().p;
-	vec3 Position(Pos.x, Pos.y, Pos.z);
+	vec3 Position(Pose.p.x, Pose.p.y, Pose.p.z);
 
 	mat4 RotMat;
 	{
-		physx::PxQuat dynQuat = mLink->getGlobalPose().q;
-		auto xVec = dynQuat.getBasisVector0();
-		auto yVec = dynQuat.getBasisVector1();
-		auto zVec = dynQuat.getBasisVector2();
+		auto xVec = Pose.q.getBasisVector0();
+		auto yVec = Pose.q.getBasisVector1();
+		auto zVec = Pose.q.getBasisVector2();
 		RotMat = mat4(vec4(xVec.x, xVec.y, xVec.z, 0), vec4(yVec.x, yVec.y, yVec.z, 0), vec4(zVec.x, zVec.y, zVec.z, 0), vec4(0, 0, 0, 1));
 	}
 
-	mNode.transform = translate(Position) * RotMat * scale(mScale.x, mScale.y, mScale.z);
-
-	for (auto Child : mChildren)
-		Child->Update();
+	return translate(Position) * RotMat * scale(Scale.x, Scale.y, Scale.z);
 }
 
-void CreaturePart::Draw(mat4 ViewProjection, std::shared_ptr<ShaderResource> Shader)
+void CreaturePart::GetTransformBounds(const mat4& Transform, vec3& Min, vec3& Max)
 {
-	mNode.draw(ViewProjection, Shader);
-
-	for (auto Child : mChildren)
-		Child->Draw(ViewProjection, Shader);
+	/// The cube mesh goes from -1 to 1, so each column of the rotated and scaled transform is a half axis of the box
+	for (int i = 0; i < 3; i++)
+	{
+		float HalfExtent = std::abs(Transform[0][i]) + std::abs(Transform[1][i]) + std::abs(Transform[2][i]);
+		Min[i] = Transform[3][i] - HalfExtent;
+		Max[i] = Transform[3][i] + HalfExtent;
+	}
 }
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "config.h"
-#include "render/GraphicsNode.h"
+#include "core/math/mat4.h"
 #include <PxPhysicsAPI.h>
 
 class CreaturePart
@@ -12,32 +12,28 @@ public:
 	physx::PxShapeFlags mShapeFlags;
 	physx::PxArticulationJointReducedCoordinate* mJoint = nullptr;
 	physx::PxArticulationAxis::Enum mJointAxis;
-	
-	std::vector<CreaturePart*> mChildren;
 
-	GraphicsNode mNode;
 	vec3 mScale;
-	vec3 mJointPosition;
-	vec3 mRelativePosition;
-	vec3 mParentNormal;
 
 	/// These values are for the activation
 	float mMaxJointVel = 10;
 	float mJointOscillationSpeed = 2;
 
+	/// Parts are plain values stored by their Creature, the creature owns the links and releases them
 	CreaturePart(physx::PxMaterial* PhysicsMaterial, physx::PxShapeFlags ShapeFlags, float MaxJointVel, float JointOscillationSpeed);
-	~CreaturePart();
 
-	void AddBoxShape(physx::PxPhysics* Physics, vec3 Scale, GraphicsNode Node);
+	void AddBoxShape(physx::PxPhysics* Physics, vec3 Scale);
 
-	CreaturePart* AddChild(physx::PxPhysics* Physics, physx::PxArticulationReducedCoordinate* Articulation, physx::PxMaterial* PhysicsMaterial, 
-				physx::PxShapeFlags ShapeFlags, GraphicsNode Node, vec3 Scale, vec3 RelativePosition, vec3 JointPosition, float MaxJointVel, float JointOscillationSpeed, 
+	CreaturePart CreateChild(physx::PxPhysics* Physics, physx::PxArticulationReducedCoordinate* Articulation, physx::PxMaterial* PhysicsMaterial, 
+				physx::PxShapeFlags ShapeFlags, vec3 Scale, vec3 RelativePosition, vec3 JointPosition, float MaxJointVel, float JointOscillationSpeed, 
 				physx::PxArticulationAxis::Enum JointAxis, physx::PxArticulationDrive PosDrive, physx::PxArticulationMotion::Enum JointMotion, physx::PxArticulationLimit JointLimit);
 
 	/// TODO: Add options to this for different styled joints
 	/// PosDrive should probably be a parameter
 	void ConfigureJoint(physx::PxArticulationAxis::Enum JointAxis, physx::PxArticulationMotion::Enum JointMotion, physx::PxArticulationLimit JointLimit, physx::PxArticulationDrive PosDrive);
-	void Activate(float TimePassed);
-	void Update();
-	void Draw(mat4 ViewProjection, std::shared_ptr<ShaderResource> Shader = nullptr);
+
+	/// The transform a part with the pose and scale is drawn with
+	static mat4 MakeTransform(const physx::PxTransform& Pose, vec3 Scale);
+	/// The world space box around a part drawn with the transform
+	static void GetTransformBounds(const mat4& Transform, vec3& Min, vec3& Max);
 };
\ No newline at end of file
@@ -0,0 +1,31 @@
+#include "FixedStepScheduler.h"
+#include <cmath>
+
+FixedStepScheduler::FixedStepScheduler(float StepSize, unsigned int MaxStepsPerFrame) : mStepSize(StepSize), mMaxStepsPerFrame(MaxStepsPerFrame)
+{
+	/// Intentionally left blank
+}
+
+unsigned int FixedStepScheduler::Advance(double DeltaSeconds)
+{
+	mAccumulator += DeltaSeconds;
+
+	unsigned int Steps = (unsigned int)std::floor(mAccumulator / mStepSize);
+
+	/// Anything over the budget is let go of, catching up on it would only make the next frame take even longer
+	if (Steps > mMaxStepsPerFrame)
+	{
+		double Dropped = (double)(Steps - mMaxStepsPerFrame) * mStepSize;
+		mDroppedTime += Dropped;
+		mAccumulator -= Dropped;
+		Steps = mMaxStepsPerFrame;
+	}
+
+	mAccumulator -= (double)Steps * mStepSize;
+	if (mAccumulator < 0)
+		mAccumulator = 0;
+
+	mStepsLastFrame = Steps;
+	mTotalSteps += Steps;
+	return Steps;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "config.h"
+
+/// Turns the wall time between frames into a number of fixed size physics steps.
+/// Time that doesn't add up to a whole step is carried over to the next frame, and if a frame would need more steps than
+/// mMaxStepsPerFrame the rest is dropped and counted, instead of piling up and making every following frame slower
+class FixedStepScheduler
+{
+public:
+	float mStepSize;
+	unsigned int mMaxStepsPerFrame;
+
+	/// Time that hasn't been stepped yet, always less than a step after Advance
+	double mAccumulator = 0;
+	/// Simulation time that was thrown away because the step budget ran out, since construction
+	double mDroppedTime = 0;
+	unsigned int mStepsLastFrame = 0;
+	unsigned int mTotalSteps = 0;
+
+	FixedStepScheduler(float StepSize = 1.0f / 60.0f, unsigned int MaxStepsPerFrame = 4);
+
+	/// Adds the time that passed and returns how many steps should be taken for it
+	unsigned int Advance(double DeltaSeconds);
+};
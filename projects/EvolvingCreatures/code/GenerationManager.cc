@@ -1,11 +1,29 @@
 #include "GenerationManager.h"
 #include "RandomUtils.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <cmath>
 
-GenerationManager::GenerationManager(physx::PxPhysics* Physics, physx::PxDefaultCpuDispatcher* Dispatcher, GraphicsNode CubeNode) : mPhysics(Physics), mDispatcher(Dispatcher), mCubeNode(CubeNode)
+GenerationManager::GenerationManager(physx::PxPhysics* Physics, physx::PxDefaultCpuDispatcher* Dispatcher, GraphicsNode CubeNode) : mPhysics(Physics), mDispatcher(Dispatcher), mScenePool(Physics, Dispatcher), mCubeNode(CubeNode)
 {
 	/// Intentionally left blank
 }
 
+GenerationManager::~GenerationManager()
+{
+	DiscardOffspring();
+
+	for (auto Bundle : mCreatures)
+	{
+		delete Bundle;
+	}
+
+	while (mLoadedCreatures.size() > 0)
+	{
+		RemoveLoadedCreature(0);
+	}
+}
+
 void GenerationManager::GenerateCreatures(int GenerationSize, bool bUseLoadedCreatures)
 {
 	/// Destroys any creatures that exist in the list already
@@ -14,6 +32,7 @@ void GenerationManager::GenerateCreatures(int GenerationSize, bool bUseLoadedCre
 		delete mCreatures[i];
 	}
 	mCreatures.erase(mCreatures.begin(), mCreatures.end());
+	bControllerBatchDirty = true;
 
 	mGenerationSize = GenerationSize;
 	physx::PxMaterial* MaterialPtr = mPhysics->createMaterial(0.5f, 0.5f, 0.1f);
@@ -23,148 +42,361 @@ void GenerationManager::GenerateCreatures(int GenerationSize, bool bUseLoadedCre
 	{
 		for (auto LoadedBundle : mLoadedCreatures)
 		{
-			Creature* NewCreature = LoadedBundle->mCreature->GetCreatureCopy(mPhysics);
+			Creature* NewCreature = new Creature(LoadedBundle->mCreature->mGenome, mPhysics, MaterialPtr, ShapeFlags);
 			NewCreature->SetPosition(vec3(0, 20, 0));
 
-			/// ----------------------------------------
-			/// [BEGIN] CREATURE PERSONAL SCENE SETUP
-			/// ----------------------------------------
+			AddCreatureToGeneration(NewCreature);
+
+			/// If someone theoretically loaded in more creatures then the generation allows only copy the amount that will fill the generation
+			if (mCreatures.size() >= mGenerationSize)
+				break;
+		}
+	}
+
+	/// The random creatures are built on the worker threads, each from its own stream so the result doesn't depend on which thread got it
+	int FirstRandomCreature = mCreatures.size();
+	std::vector<Creature*> RandomCreatures(mGenerationSize - FirstRandomCreature);
 
-			physx::PxTolerancesScale ToleranceScale;
+	ParallelFor(RandomCreatures.size(), mBuildThreads, [&](int i)
+	{
+		ScopedRandomStream Stream(MakeCreatureStream(mRunSeed, 0, FirstRandomCreature + i));
 
-			ToleranceScale.length = 1;
-			ToleranceScale.speed = 981;
+		CreatureGenome Genome(vec3(RandomFloatInRange(0.5, 3), RandomFloatInRange(0.5, 3), RandomFloatInRange(0.5, 3)));
 
-			physx::PxSceneDesc SceneDesc(ToleranceScale);
-			SceneDesc.gravity = { 0, -9.8, 0 };
-			SceneDesc.cpuDispatcher = mDispatcher;
-			SceneDesc.filterShader = physx::PxDefaultSimulationFilterShader;
-			SceneDesc.kineKineFilteringMode = physx::PxPairFilteringMode::eKEEP;
-			SceneDesc.staticKineFilteringMode = physx::PxPairFilteringMode::eKEEP;
+		int NumberOfBodyParts = RandomIntInRange(1, 4);
+		for (int j = 0; j < NumberOfBodyParts; j++)
+			Genome.AddRandomPart();
 
-			physx::PxScene* Scene = mPhysics->createScene(SceneDesc);
-			Scene->setFlag(physx::PxSceneFlag::eENABLE_ACTIVE_ACTORS, true);
+		RandomCreatures[i] = new Creature(Genome, mPhysics, MaterialPtr, ShapeFlags);
+		RandomCreatures[i]->SetPosition(vec3(0, 20, 0));
+	});
 
-			physx::PxRigidStatic* PlaneCollision = mPhysics->createRigidStatic(physx::PxTransformFromPlaneEquation(physx::PxPlane(physx::PxVec3(0.f, 1.f, 0.f), 0.f)));
-			{
-				physx::PxShape* shape = mPhysics->createShape(physx::PxPlaneGeometry(), &MaterialPtr, 1, true, ShapeFlags);
-				PlaneCollision->attachShape(*shape);
-				shape->release();
-			}
+	/// The scene pool isn't thread safe, so they're added to the generation in order on this thread
+	for (auto NewCreature : RandomCreatures)
+	{
+		AddCreatureToGeneration(NewCreature);
+	}
 
-			Scene->addActor(*PlaneCollision);
+	MaterialPtr->release();
+}
 
-			/// ----------------------------------------
-			/// [END] CREATURE PERSONAL SCENE SETUP
-			/// ----------------------------------------
+void GenerationManager::AddCreatureToGeneration(Creature* NewCreature)
+{
+	bControllerBatchDirty = true;
 
-			NewCreature->AddToScene(Scene);
-				
-			CreatureBundle* NewCreatureStats = new CreatureBundle(NewCreature, Scene, PlaneCollision);
-			mCreatures.push_back(NewCreatureStats);
+	if (mSceneMode == CreatureSceneMode::SharedScene)
+	{
+		/// Id 0 is the ground, so the creatures start counting from 1
+		NewCreature->SetCollisionGroup(mCreatures.size() + 1);
 
-			/// If someone theoretically loaded in more creatures then the generation allows only copy the amount that will fill the generation
-			if (mCreatures.size() >= mGenerationSize)
-				break;
-		}
+		physx::PxScene* Scene = mScenePool.GetSharedScene();
+		NewCreature->AddToScene(Scene);
+		mCreatures.push_back(new CreatureBundle(NewCreature, Scene, nullptr));
+	}
+	else
+	{
+		physx::PxScene* Scene = mScenePool.Acquire();
+		NewCreature->AddToScene(Scene);
+		mCreatures.push_back(new CreatureBundle(NewCreature, Scene, &mScenePool));
 	}
+}
 
-	for (int i = mCreatures.size(); i < mGenerationSize; i++)
+void GenerationManager::Simulate(float StepSize)
+{
+	if (mSceneMode == CreatureSceneMode::SharedScene)
 	{
-		Creature* reature = new Creature(mPhysics, MaterialPtr, ShapeFlags, mCubeNode, vec3(RandomFloatInRange(0.5, 3), RandomFloatInRange(0.5, 3), RandomFloatInRange(0.5, 3)));
+		/// The whole generation is stepped in one go, the loaded creatures still have personal scenes so those are kicked off alongside it
+		physx::PxScene* SharedScene = mScenePool.GetSharedScene();
+		SharedScene->simulate(StepSize);
 
-		int NumberOfBodyParts = RandomIntInRange(1, 4);
-		for (int i = 0; i < NumberOfBodyParts; i++)
-			reature->AddRandomPart(mPhysics, MaterialPtr, ShapeFlags, mCubeNode);
+		for (auto Bundle : mLoadedCreatures)
+		{
+			if (Bundle->bActive)
+				Bundle->mScene->simulate(StepSize);
+		}
 
-		reature->SetPosition(vec3(0, 20, 0));
+		SharedScene->fetchResults(true);
+		for (auto Bundle : mCreatures)
+		{
+			if (!NeedsStepping(Bundle))
+				continue;
 
-		/// ----------------------------------------
-		/// [BEGIN] CREATURE PERSONAL SCENE SETUP
-		/// ----------------------------------------
+			AccumulateSpeed(Bundle);
+			Bundle->mLifetime += StepSize;
+		}
 
-		physx::PxTolerancesScale ToleranceScale;
+		for (auto Bundle : mLoadedCreatures)
+		{
+			if (!Bundle->bActive)
+				continue;
+
+			Bundle->mScene->fetchResults(true);
+			Bundle->mLifetime += StepSize;
+		}
+	}
+	else if (bParallelStepping)
+	{
+		/// Kick off every scene before blocking on any of them, that way the dispatcher's worker threads can chew through many of the tiny scenes at once
+		for (auto Bundle : mCreatures)
+		{
+			if (NeedsStepping(Bundle))
+				Bundle->mScene->simulate(StepSize);
+		}
 
-		ToleranceScale.length = 1;
-		ToleranceScale.speed = 981;
+		for (auto Bundle : mLoadedCreatures)
+		{
+			if (Bundle->bActive)
+				Bundle->mScene->simulate(StepSize);
+		}
 
-		physx::PxSceneDesc SceneDesc(ToleranceScale);
-		SceneDesc.gravity = { 0, -9.8, 0 };
-		SceneDesc.cpuDispatcher = mDispatcher;
-		SceneDesc.filterShader = physx::PxDefaultSimulationFilterShader;
-		SceneDesc.kineKineFilteringMode = physx::PxPairFilteringMode::eKEEP;
-		SceneDesc.staticKineFilteringMode = physx::PxPairFilteringMode::eKEEP;
+		/// Each bundle only reads from its own scene, so collecting the results in order keeps the stats the same as stepping them one at a time
+		for (auto Bundle : mCreatures)
+		{
+			if (!NeedsStepping(Bundle))
+				continue;
 
-		physx::PxScene* Scene = mPhysics->createScene(SceneDesc);
-		Scene->setFlag(physx::PxSceneFlag::eENABLE_ACTIVE_ACTORS, true);
+			Bundle->mScene->fetchResults(true);
+			AccumulateSpeed(Bundle);
+			Bundle->mLifetime += StepSize;
+		}
 
-		physx::PxRigidStatic* PlaneCollision = mPhysics->createRigidStatic(physx::PxTransformFromPlaneEquation(physx::PxPlane(physx::PxVec3(0.f, 1.f, 0.f), 0.f)));
+		for (auto Bundle : mLoadedCreatures)
 		{
-			physx::PxShape* shape = mPhysics->createShape(physx::PxPlaneGeometry(), &MaterialPtr, 1, true, ShapeFlags);
-			PlaneCollision->attachShape(*shape);
-			shape->release();
+			if (!Bundle->bActive)
+				continue;
+
+			Bundle->mScene->fetchResults(true);
+			Bundle->mLifetime += StepSize;
 		}
+	}
+	else
+	{
+		for (auto Bundle : mCreatures)
+		{
+			if (!NeedsStepping(Bundle))
+				continue;
 
-		Scene->addActor(*PlaneCollision);
+			Bundle->mScene->simulate(StepSize);
+			Bundle->mScene->fetchResults(true);
+			AccumulateSpeed(Bundle);
+			Bundle->mLifetime += StepSize;
+		}
 
-		/// ----------------------------------------
-		/// [END] CREATURE PERSONAL SCENE SETUP
-		/// ----------------------------------------
+		for (auto Bundle : mLoadedCreatures)
+		{
+			if (!Bundle->bActive)
+				continue;
 
-		reature->AddToScene(Scene);
-			
-		CreatureBundle* NewCreature = new CreatureBundle(reature, Scene, PlaneCollision);
-		mCreatures.push_back(NewCreature);
+			Bundle->mScene->simulate(StepSize);
+			Bundle->mScene->fetchResults(true);
+			Bundle->mLifetime += StepSize;
+		}
 	}
 
-	MaterialPtr->release();
+	if (mCurrentState == GenerationManagerState::Running)
+	{
+		mStepsSinceStart++;
+		mCurrentGenerationStep++;
+		mCurrentGenerationDuration = mCurrentGenerationStep * StepSize;
+	}
 }
 
-void GenerationManager::Simulate(float StepSize)
+void GenerationManager::AccumulateSpeed(CreatureBundle* Bundle)
 {
-	for (auto Bundle : mCreatures)
-	{
-		Bundle->mScene->simulate(StepSize);
-		Bundle->mScene->fetchResults(true);
+	/// The root state is read every step so EndEvaluation can use it as well
+	Bundle->mCreature->PullRootState();
 
-		if (mCurrentState == GenerationManagerState::Running)
+	if (mCurrentState != GenerationManagerState::Running)
+		return;
+
+	physx::PxVec3 Vel = Bundle->mCreature->GetRootLinearVelocity();
+	physx::PxVec3 HorizontalVel = { Vel.x, 0, Vel.z };
+	Bundle->mSumHorizontalSpeed += HorizontalVel.magnitude();
+	Bundle->mEvaluationSteps++;
+
+	CheckEarlyStop(Bundle);
+}
+
+/// Works out the average speed and the fitness of a creature that has been evaluated for EvaluationSteps
+static void ScoreBundle(CreatureBundle* Bundle, unsigned int EvaluationSteps)
+{
+	Bundle->mAverageSpeed = Bundle->mSumHorizontalSpeed / (EvaluationSteps > 0 ? EvaluationSteps : 1);
+
+	/// This is to only consider horizontal movement interesting in fitness calculation
+	physx::PxVec3 Pos = Bundle->mCreature->GetRootPose().p;
+	Pos = { Pos.x, 0, Pos.z };
+	Bundle->mFitness = Pos.magnitude();
+}
+
+bool GenerationManager::CheckEarlyStop(CreatureBundle* Bundle)
+{
+	if (!mEarlyStop.bEnabled || mCurrentState != GenerationManagerState::Running || Bundle->bTerminated || Bundle->bFitnessKnown)
+		return false;
+
+	physx::PxTransform Pose = Bundle->mCreature->GetRootPose();
+	physx::PxVec3 Vel = Bundle->mCreature->GetRootLinearVelocity();
+	physx::PxVec3 HorizontalPos = { Pose.p.x, 0, Pose.p.z };
+
+	bool bExploded = !Pose.isFinite() || !Vel.isFinite() || Pose.p.magnitude() > mEarlyStop.mExplosionDistance || Vel.magnitude() > mEarlyStop.mExplosionSpeed;
+	bool bStagnated = false;
+	bool bOutOfReach = false;
+
+	if (!bExploded && mEarlyStop.mStagnationWindowSteps > 0 && Bundle->mEvaluationSteps >= mEarlyStop.mStagnationGraceSteps)
+	{
+		/// The first window starts where the creature is once the grace period is over
+		if (Bundle->mStagnationAnchorStep < mEarlyStop.mStagnationGraceSteps)
 		{
-			physx::PxVec3 Vel = Bundle->mCreature->mRootPart->mLink->getLinearVelocity();
-			physx::PxVec3 HorizontalVel = { Vel.x, 0, Vel.z };
-			Bundle->mSumHorizontalSpeed += HorizontalVel.magnitude();
+			Bundle->mStagnationAnchor = HorizontalPos;
+			Bundle->mStagnationAnchorStep = Bundle->mEvaluationSteps;
+		}
+		else if (Bundle->mEvaluationSteps - Bundle->mStagnationAnchorStep >= mEarlyStop.mStagnationWindowSteps)
+		{
+			bStagnated = (HorizontalPos - Bundle->mStagnationAnchor).magnitude() < mEarlyStop.mStagnationDistance;
+			Bundle->mStagnationAnchor = HorizontalPos;
+			Bundle->mStagnationAnchorStep = Bundle->mEvaluationSteps;
 		}
 	}
 
-	for (auto Bundle : mLoadedCreatures)
+	if (!bExploded && mEarlyStop.bUseFitnessBound)
+	{
+		/// In the steady state a creature has to beat the worst elite once there are enough of them
+		float Cutoff = mSurvivorCutoff;
+		if (mEvolutionMode == EvolutionMode::SteadyState)
+			Cutoff = mElites.size() >= mGenerationSurvivors && mGenerationSurvivors > 0 ? mElites.back().second : -INFINITY;
+
+		unsigned int RemainingSteps = mGenerationDurationSteps > Bundle->mEvaluationSteps ? mGenerationDurationSteps - Bundle->mEvaluationSteps : 0;
+		bOutOfReach = HorizontalPos.magnitude() + mEarlyStop.mMaxHorizontalSpeed * RemainingSteps * mStepSize < Cutoff;
+	}
+
+	if (!bExploded && !bStagnated && !bOutOfReach)
+		return false;
+
+	if (bExploded)
 	{
-		Bundle->mScene->simulate(StepSize);
-		Bundle->mScene->fetchResults(true);
+		/// Ranks last, see IsFitter
+		Bundle->mFitness = NAN;
 	}
+	else
+	{
+		ScoreBundle(Bundle, Bundle->mEvaluationSteps);
+	}
+
+	/// The fitness bound depends on how good the rest of the run has been so far, only the other two rules always end the same way for the same genome
+	if (bUseFitnessCache && !bOutOfReach)
+		mFitnessCache[Bundle->mGenomeHash] = Bundle->mFitness;
+
+	Bundle->bTerminated = true;
+	Bundle->bOutOfReach = bOutOfReach && !bExploded;
+	mEarlyStopCount++;
+	UpdateSleepState(Bundle);
+	return true;
 }
 
-void GenerationManager::UpdateCreatures(float dt)
+bool GenerationManager::NeedsStepping(const CreatureBundle* Bundle) const
 {
-	for (auto Bundle : mCreatures)
+	if (!Bundle->bActive)
+		return false;
+
+	if (mCurrentState == GenerationManagerState::Running)
+		return !(Bundle->bFitnessKnown || Bundle->bTerminated || Bundle->bAwaitingReplacement || Bundle->mStartDelaySteps > 0);
+
+	/// Once the evolution is done only the creature that is being looked at moves
+	if (mCurrentState == GenerationManagerState::Finished && mDisplayedCreatureIndex >= 0)
+		return Bundle->mCreature == mSortedCreatures[mDisplayedCreatureIndex].first;
+
+	return true;
+}
+
+void GenerationManager::UpdateSleepState(CreatureBundle* Bundle)
+{
+	/// Personal scenes that aren't stepped cost nothing already, in the shared scene the articulation has to be put to sleep so the solver skips it.
+	/// Nothing else in the scene collides with it, so it stays asleep until it is woken up here or moved
+	if (mSceneMode != CreatureSceneMode::SharedScene)
+		return;
+
+	if (NeedsStepping(Bundle))
+		Bundle->mCreature->mArticulation->wakeUp();
+	else
+		Bundle->mCreature->mArticulation->putToSleep();
+}
+
+void GenerationManager::FindKnownFitness(CreatureBundle* Bundle, std::unordered_map<uint64_t, CreatureBundle*>* FirstWithHash)
+{
+	Bundle->bFitnessKnown = false;
+	Bundle->mFitnessSource = nullptr;
+
+	if (!bUseFitnessCache)
+		return;
+
+	Bundle->mGenomeHash = Bundle->mCreature->mGenome.GetHash();
+
+	auto Cached = mFitnessCache.find(Bundle->mGenomeHash);
+	if (Cached != mFitnessCache.end())
 	{
-		Bundle->mLifetime += dt;
-		Bundle->mCreature->Update();
+		Bundle->bFitnessKnown = true;
+		Bundle->mFitness = Cached->second;
+		mFitnessCacheHits++;
+		UpdateSleepState(Bundle);
+		return;
+	}
+
+	if (FirstWithHash == nullptr)
+		return;
+
+	/// Only the first of several identical creatures is evaluated, the rest get its fitness
+	auto [First, bInserted] = FirstWithHash->insert({ Bundle->mGenomeHash, Bundle });
+	if (!bInserted)
+	{
+		Bundle->bFitnessKnown = true;
+		Bundle->mFitnessSource = First->second;
+		mFitnessCacheHits++;
+		UpdateSleepState(Bundle);
 	}
 }
 
-void GenerationManager::DrawCreatures(mat4 ViewProjection, std::shared_ptr<ShaderResource> Shader)
+void GenerationManager::WritePoseSnapshot(PoseSnapshot& Snapshot)
 {
-	for (auto Bundle : mCreatures)
+	if (mCurrentState == GenerationManagerState::Finished)
+	{
+		if (mDisplayedCreatureIndex >= 0 && mDisplayedCreatureIndex < mSortedCreatures.size())
+		{
+			Snapshot.mDisplayedCreature = Snapshot.mCreatures.size();
+			Snapshot.AddCreature(*mSortedCreatures[mDisplayedCreatureIndex].first, &mCubeNode.meshes, mSortedCreatures[mDisplayedCreatureIndex].second, true);
+		}
+	}
+	else if (mCurrentState == GenerationManagerState::Running || mCurrentState == GenerationManagerState::Waiting)
 	{
-		Bundle->mCreature->Draw(ViewProjection, Shader);
+		/// Creatures that are skipping their evaluation would just hang where they were spawned
+		for (auto Bundle : mCreatures)
+		{
+			if (NeedsStepping(Bundle))
+				Snapshot.AddCreature(*Bundle->mCreature, &mCubeNode.meshes, GetRunningFitness(Bundle));
+		}
 	}
+
+	/// A paused creature isn't moving, but it still has to be drawn where it stopped
+	for (auto Bundle : mLoadedCreatures)
+		Snapshot.AddCreature(*Bundle->mCreature, &mCubeNode.meshes, GetRunningFitness(Bundle), Bundle->bDrawBoundingBox);
 }
 
-void GenerationManager::DrawFinishedCreatures(mat4 ViewProjection, int CreatureIndex)
+void GenerationManager::SetDisplayedCreature(int CreatureIndex)
 {
 	/// Assert that sorted list is not empty and that you aren't sending an out of bounds index
-	assert(mSortedCreatures.size() > 0 && CreatureIndex <= mSortedCreatures.size());
+	assert(mSortedCreatures.size() > 0 && CreatureIndex < mSortedCreatures.size());
 
-	mSortedCreatures[CreatureIndex].first->Draw(ViewProjection);
+	if (CreatureIndex != mDisplayedCreatureIndex)
+	{
+		mDisplayedCreatureIndex = CreatureIndex;
+		for (auto Bundle : mCreatures)
+			UpdateSleepState(Bundle);
+	}
+}
+
+float GenerationManager::GetRunningFitness(const CreatureBundle* Bundle) const
+{
+	/// Read from the link rather than the cached root state, which is only pulled for creatures that are being evaluated
+	physx::PxVec3 Pos = Bundle->mCreature->mParts[0].mLink->getGlobalPose().p;
+	return physx::PxVec3(Pos.x, 0, Pos.z).magnitude();
 }
 
 void GenerationManager::SetPositionOfCreatures(vec3 Position)
@@ -175,15 +407,32 @@ void GenerationManager::SetPositionOfCreatures(vec3 Position)
 		Bundle->mCreature->SetPosition(Position);
 		//creature->mCreature->AddToScene(creature->mScene);
 		Bundle->mCreature->ClearForceAndTorque();
+
+		/// Moving an articulation wakes it up, creatures that already know their fitness have to be put back to sleep
+		UpdateSleepState(Bundle);
 	}
 }
 
 void GenerationManager::Activate()
 {
-	for (auto Bundle : mCreatures)
+	if (bControllerBatchDirty)
+	{
+		mControllerBatch.Clear();
+		for (auto Bundle : mCreatures)
+			mControllerBatch.Add(Bundle->mCreature);
+
+		mControllerLifetimes.resize(mCreatures.size());
+		mControllerActive.resize(mCreatures.size());
+		bControllerBatchDirty = false;
+	}
+
+	for (int i = 0; i < mCreatures.size(); i++)
 	{
-		Bundle->mCreature->Activate(Bundle->mLifetime);
+		mControllerLifetimes[i] = mCreatures[i]->mLifetime;
+		mControllerActive[i] = NeedsStepping(mCreatures[i]);
 	}
+
+	mControllerBatch.Activate(mControllerLifetimes.data(), mControllerActive.data());
 }
 
 void GenerationManager::Start(int NumberOfGenerations, float GenTime, int GenerationSurvivors, float MutationChance, float MutationSeverity, int GenerationSize, bool bUseLoadedCreatures)
@@ -200,57 +449,63 @@ void GenerationManager::Start(int NumberOfGenerations, float GenTime, int Genera
 
 	/// Clear the sorted list of victors
 	mSortedCreatures.erase(mSortedCreatures.begin(), mSortedCreatures.end());
+	mGenerationBestFitness.clear();
 
 	mNumberOfGenerations = NumberOfGenerations;
 	mGenerationDurationSeconds = GenTime;
+	mGenerationDurationSteps = (unsigned int)std::ceil(GenTime / mStepSize);
 
-	mGenerationSurvivors = GenerationSurvivors;
+	/// Offspring are bred from the survivors, with none the generational cull has nothing to breed from and steady state never frees a slot
+	mGenerationSurvivors = std::max(1, GenerationSurvivors);
 	mMutationChance = MutationChance;
 	mMutationSeverity = MutationSeverity;
 
 	mCurrentGeneration = 0;
 	mCurrentGenerationDuration = 0;
+	mCurrentGenerationStep = 0;
+
+	DiscardOffspring();
+	mElites.clear();
+	mFitnessCache.clear();
+	mFitnessCacheHits = 0;
+	mSurvivorCutoff = -INFINITY;
+	mEarlyStopCount = 0;
+	mDisplayedCreatureIndex = -1;
+	mStepsSinceStart = 0;
+	mEvaluationCount = 0;
+	mOffspringCount = 0;
+	mCurrentGenerationBestFitness = 0;
 
 	StartEvalutation();
 }
 
-/// Utility for checking if the creatures are sorted yet by their fitness, only used by cull generation and when a generation finishes so we can render the best ones
-static bool IsSorted(const std::vector<std::pair<Creature*, float>>& Arr)
+/// Orders fitness from best to worst, a NaN fitness from a creature that blew up always ranks last
+static bool IsFitter(float A, float B)
 {
-	for (int i = 0; i < Arr.size() - 1; i++)
-	{
-		if (Arr[i + 1].second > Arr[i].second)
-			return false;
-	}
-	return true;
+	if (std::isnan(B))
+		return !std::isnan(A);
+	return A > B;
 }
 
-/// Utility for checking if the creatures are sorted yet by their fitness, only used by cull generation and when a generation finishes so we can render the best ones
-static void Sort(std::vector<std::pair<Creature*, float>>& Arr)
+/// Like IsFitter, but a creature the fitness bound stopped only has its distance so far, so it ranks below every creature that wasn't stopped by it.
+/// A creature that blew up still ranks last
+static bool RanksAbove(const CreatureBundle* A, const CreatureBundle* B)
 {
-	/// Sort the creatures based on their fitness
-	while (!IsSorted(Arr))
-	{
-		for (int i = 0; i < Arr.size(); i++)
-		{
-			int j = i;
-			while (j < Arr.size() - 1 && Arr[j].second < Arr[j + 1].second)
-				j++;
-			std::pair<Creature*, float> Temp = Arr[j];
-			Arr[j] = Arr[i];
-			Arr[i] = Temp;
-		}
-	}
+	if (!std::isnan(A->mFitness) && !std::isnan(B->mFitness) && A->bOutOfReach != B->bOutOfReach)
+		return !A->bOutOfReach;
+	return IsFitter(A->mFitness, B->mFitness);
 }
 
-void GenerationManager::Update(float DeltaTime)
+void GenerationManager::Update()
 {
-	if (mCurrentState == GenerationManagerState::Running)
+	if (mCurrentState == GenerationManagerState::Running && mEvolutionMode == EvolutionMode::SteadyState)
+	{
+		UpdateSteadyState();
+	}
+	else if (mCurrentState == GenerationManagerState::Running)
 	{
-		mCurrentGenerationDuration += DeltaTime;
-		if (mCurrentGenerationDuration > mGenerationDurationSeconds)
+		if (mCurrentGenerationStep >= mGenerationDurationSteps)
 		{
-			mCurrentGenerationDuration = 0;
 			mCurrentGeneration += 1;
 
 			EndEvaluation();
@@ -266,158 +521,354 @@ void GenerationManager::Update(float DeltaTime)
 			if (mCurrentGeneration >= mNumberOfGenerations)
 			{
 				mCurrentState = GenerationManagerState::Finished;
-
-				for (auto Bundle : mCreatures)
-				{
-					mSortedCreatures.push_back({ Bundle->mCreature, Bundle->mFitness });
-				}
-
-				/// Sort the creatures based on their fitness
-				Sort(mSortedCreatures);
+				SortFinishedCreatures();
 			}
 		}
 	}
 }
 
-void GenerationManager::StartEvalutation()
+void GenerationManager::SortFinishedCreatures()
 {
-	for (auto Bundle : mCreatures)
+	/// Built once here and left alone until the next Start, creatures that rank the same keep their generation order
+	std::vector<CreatureBundle*> Ranked = mCreatures;
+	std::stable_sort(Ranked.begin(), Ranked.end(), RanksAbove);
+
+	mSortedCreatures.reserve(Ranked.size());
+	for (auto Bundle : Ranked)
 	{
-		Bundle->mSumHorizontalSpeed = 0;
+		mSortedCreatures.push_back({ Bundle->mCreature, Bundle->mFitness });
 	}
-
-	mEvaluationStartTime = std::chrono::high_resolution_clock::now();
 }
 
-void GenerationManager::EndEvaluation()
+void GenerationManager::UpdateSteadyState()
 {
-	mEvaluationDuration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - mEvaluationStartTime).count() / 1000.f;
+	/// Offspring are swapped in a fixed number of steps after they were queued, whether or not the builder finished early
+	if (mBreedTask.valid() && mStepsSinceStart >= mBreedInstallStep)
+		InstallOffspring();
 
 	for (auto Bundle : mCreatures)
 	{
-		Bundle->mAverageSpeed = Bundle->mSumHorizontalSpeed / mEvaluationDuration;
+		if (Bundle->bAwaitingReplacement)
+			continue;
+
+		if (Bundle->mStartDelaySteps > 0)
+		{
+			Bundle->mStartDelaySteps--;
+			if (Bundle->mStartDelaySteps == 0)
+				UpdateSleepState(Bundle);
+			continue;
+		}
+
+		/// Creatures with a cached fitness are done as soon as they're swapped in, they were already considered for the elites the first time around
+		if (!Bundle->bFitnessKnown)
+		{
+			if (!Bundle->bTerminated && Bundle->mEvaluationSteps < mGenerationDurationSteps)
+				continue;
+
+			/// Creatures that were stopped early were scored, and cached if it was safe to, by CheckEarlyStop
+			if (!Bundle->bTerminated)
+			{
+				ScoreBundle(Bundle, Bundle->mEvaluationSteps);
+				if (bUseFitnessCache)
+					mFitnessCache[Bundle->mGenomeHash] = Bundle->mFitness;
+			}
+
+			/// Keep the elites sorted best first, a creature that ties with an elite goes after it
+			auto Position = std::upper_bound(mElites.begin(), mElites.end(), Bundle->mFitness,
+				[](float Fitness, const std::pair<CreatureGenome, float>& Elite) { return IsFitter(Fitness, Elite.second); });
+			if (Position - mElites.begin() < mGenerationSurvivors)
+			{
+				mElites.insert(Position, { Bundle->mCreature->mGenome, Bundle->mFitness });
+				if (mElites.size() > mGenerationSurvivors)
+					mElites.pop_back();
+			}
+		}
+
+		Bundle->bAwaitingReplacement = true;
+		UpdateSleepState(Bundle);
+
+		if (Bundle->mFitness > mCurrentGenerationBestFitness)
+			mCurrentGenerationBestFitness = Bundle->mFitness;
+
+		/// Every mGenerationSize evaluations count as a generation, so the progress and the reports line up with the generational mode
+		mEvaluationCount++;
+		if (mEvaluationCount % mGenerationSize == 0)
+		{
+			mGenerationBestFitness.push_back(mCurrentGenerationBestFitness);
+			mCurrentGenerationBestFitness = 0;
+			mCurrentGeneration++;
+			mEvaluationDuration = mGenerationDurationSteps * mStepSize;
+			mCurrentGenerationStep = 0;
+			mCurrentGenerationDuration = 0;
+
+			if (mCurrentGeneration >= mNumberOfGenerations)
+			{
+				FinishSteadyState();
+				return;
+			}
+		}
+	}
+
+	if (!mBreedTask.valid())
+		QueueOffspring();
+}
+
+void GenerationManager::QueueOffspring()
+{
+	for (int i = 0; i < mCreatures.size(); i++)
+	{
+		if (!mCreatures[i]->bAwaitingReplacement || mElites.size() == 0)
+			continue;
+
+		/// Offspring get their streams in the order they are queued, which only depends on the seed since everything here is counted in steps
+		uint32_t Serial = mOffspringCount++;
+		RandomStream Stream = MakeCreatureStream(mRunSeed, 1 + Serial / mGenerationSize, Serial % mGenerationSize);
+
+		int ParentIndex;
+		{
+			ScopedRandomStream Scope(Stream);
+			ParentIndex = RandomInt(mElites.size());
+			Stream = ThreadRandomStream;
+		}
 
-		/// This is to only consider horizontal movement interesting in fitness calculation
-		physx::PxVec3 Pos = Bundle->mCreature->mRootPart->mLink->getGlobalPose().p;
-		Pos = { Pos.x, 0, Pos.z };
-		Bundle->mFitness = Pos.magnitude();
+		mPendingOffspring.push_back({ i, mElites[ParentIndex].first, Stream });
 	}
+
+	if (mPendingOffspring.size() == 0)
+		return;
+
+	mBreedMaterial = mPhysics->createMaterial(0.5f, 0.5f, 0.1f);
+	mBreedInstallStep = mStepsSinceStart + mBreedLatencySteps;
+
+	/// The builder only touches mPendingOffspring, which nothing else looks at until the task has been waited on
+	mBreedTask = std::async(std::launch::async, [this]()
+	{
+		physx::PxShapeFlags ShapeFlags = physx::PxShapeFlag::eVISUALIZATION | physx::PxShapeFlag::eSCENE_QUERY_SHAPE | physx::PxShapeFlag::eSIMULATION_SHAPE;
+
+		ParallelFor(mPendingOffspring.size(), mBuildThreads, [&](int i)
+		{
+			PendingOffspring& Offspring = mPendingOffspring[i];
+			ScopedRandomStream Scope(Offspring.mStream);
+			Offspring.mCreature = new Creature(Offspring.mParent.GetMutated(mMutationChance, mMutationSeverity), mPhysics, mBreedMaterial, ShapeFlags);
+		});
+	});
 }
 
-void GenerationManager::CullAndMutateGeneration(int NumberToKeep, float MutationChance, float MutationSeverity)
+void GenerationManager::InstallOffspring()
 {
-	std::vector<std::pair<Creature*, float>> SortedCreatures;
+	mBreedTask.get();
 
-	for (auto Bundle : mCreatures)
+	for (auto& Offspring : mPendingOffspring)
 	{
-		SortedCreatures.push_back({ Bundle->mCreature->GetCreatureCopy(mPhysics), Bundle->mFitness });
+		CreatureBundle* Bundle = mCreatures[Offspring.mBundleIndex];
+
+		if (mSceneMode == CreatureSceneMode::SharedScene)
+			Offspring.mCreature->SetCollisionGroup(Offspring.mBundleIndex + 1);
+
+		Bundle->ReplaceCreature(Offspring.mCreature);
+		Bundle->mCreature->SetPosition(vec3(0, 20, 0));
+
+		/// Identical offspring in the same batch are all evaluated in the steady state, there's no single point where they'd all finish together
+		FindKnownFitness(Bundle, nullptr);
 	}
+	bControllerBatchDirty = true;
+
+	mPendingOffspring.clear();
+	mBreedMaterial->release();
+	mBreedMaterial = nullptr;
+}
 
-	/// Sort the creatures based on their fitness
-	Sort(SortedCreatures);
+void GenerationManager::DiscardOffspring()
+{
+	if (!mBreedTask.valid())
+		return;
+
+	mBreedTask.get();
 
-	/// Clear the creatures that are not up to snuff
-	for (int i = NumberToKeep; i < SortedCreatures.size(); i++)
+	for (auto& Offspring : mPendingOffspring)
 	{
-		delete SortedCreatures[i].first;
+		delete Offspring.mCreature;
 	}
-	SortedCreatures.erase(SortedCreatures.begin() + NumberToKeep, SortedCreatures.end());
 
-	/// Delete the all of the CreatureBundle
-	for (int i = 0; i < mCreatures.size(); i++)
+	mPendingOffspring.clear();
+	mBreedMaterial->release();
+	mBreedMaterial = nullptr;
+}
+
+void GenerationManager::FinishSteadyState()
+{
+	DiscardOffspring();
+
+	for (auto Bundle : mCreatures)
 	{
-		delete mCreatures[i];
+		delete Bundle;
 	}
 	mCreatures.erase(mCreatures.begin(), mCreatures.end());
+	bControllerBatchDirty = true;
 
 	physx::PxShapeFlags ShapeFlags = physx::PxShapeFlag::eVISUALIZATION | physx::PxShapeFlag::eSCENE_QUERY_SHAPE | physx::PxShapeFlag::eSIMULATION_SHAPE;
 	physx::PxMaterial* MaterialPtr = mPhysics->createMaterial(0.5f, 0.5f, 0.1f);
 
-	/// Refill the mCreatures array with creatures based on mutations from the fittest
-	for (int i = 0; i < mGenerationSize; i++)
+	for (auto& [Genome, Fitness] : mElites)
 	{
-		/// ----------------------------------------
-		/// [BEGIN] CREATURE PERSONAL SCENE SETUP
-		/// ----------------------------------------
+		AddCreatureToGeneration(new Creature(Genome, mPhysics, MaterialPtr, ShapeFlags));
+		mCreatures.back()->mFitness = Fitness;
+	}
 
-		physx::PxTolerancesScale ToleranceScale;
+	MaterialPtr->release();
 
-		ToleranceScale.length = 1;
-		ToleranceScale.speed = 981;
+	SetPositionOfCreatures(vec3(0, 20, 0));
 
-		physx::PxSceneDesc SceneDesc(ToleranceScale);
-		SceneDesc.gravity = { 0, -9.8, 0 };
-		SceneDesc.cpuDispatcher = mDispatcher;
-		SceneDesc.filterShader = physx::PxDefaultSimulationFilterShader;
-		SceneDesc.kineKineFilteringMode = physx::PxPairFilteringMode::eKEEP;
-		SceneDesc.staticKineFilteringMode = physx::PxPairFilteringMode::eKEEP;
+	mCurrentState = GenerationManagerState::Finished;
+	SortFinishedCreatures();
+}
 
-		physx::PxScene* Scene = mPhysics->createScene(SceneDesc);
-		Scene->setFlag(physx::PxSceneFlag::eENABLE_ACTIVE_ACTORS, true);
+void GenerationManager::Tick()
+{
+	Activate();
+	Simulate(mStepSize);
+	Update();
+}
 
-		physx::PxRigidStatic* PlaneCollision = mPhysics->createRigidStatic(physx::PxTransformFromPlaneEquation(physx::PxPlane(physx::PxVec3(0.f, 1.f, 0.f), 0.f)));
-		{
-			physx::PxShape* shape = mPhysics->createShape(physx::PxPlaneGeometry(), &MaterialPtr, 1, true, ShapeFlags);
-			PlaneCollision->attachShape(*shape);
-			shape->release();
-		}
+void GenerationManager::StartEvalutation()
+{
+	std::unordered_map<uint64_t, CreatureBundle*> FirstWithHash;
+
+	for (int i = 0; i < mCreatures.size(); i++)
+	{
+		CreatureBundle* Bundle = mCreatures[i];
+		Bundle->mSumHorizontalSpeed = 0;
+		Bundle->mEvaluationSteps = 0;
+		Bundle->mStartDelaySteps = mEvolutionMode == EvolutionMode::SteadyState ? i * mGenerationDurationSteps / mCreatures.size() : 0;
+		Bundle->bTerminated = false;
+		Bundle->bOutOfReach = false;
+		Bundle->mStagnationAnchor = { 0, 0, 0 };
+		Bundle->mStagnationAnchorStep = 0;
+
+		/// The steady state scores every creature on its own, so a twin wouldn't be around to copy the fitness from
+		FindKnownFitness(Bundle, mEvolutionMode == EvolutionMode::Generational ? &FirstWithHash : nullptr);
+
+		/// Creatures that are held back sleep until their window starts
+		if (Bundle->mStartDelaySteps > 0)
+			UpdateSleepState(Bundle);
+	}
 
-		Scene->addActor(*PlaneCollision);
+	mCurrentGenerationStep = 0;
+	mCurrentGenerationDuration = 0;
+}
 
-		/// ----------------------------------------
-		/// [END] CREATURE PERSONAL SCENE SETUP
-		/// ----------------------------------------
-		Creature* MutatedCreature = SortedCreatures[i % SortedCreatures.size()].first->GetMutatedCreature(mPhysics, MutationChance, MutationSeverity);
-		MutatedCreature->AddToScene(Scene);
+void GenerationManager::EndEvaluation()
+{
+	/// Both of these are counted in physics steps, so the average speed is the mean over every step of the evaluation
+	unsigned int EvaluationSteps = mCurrentGenerationStep > 0 ? mCurrentGenerationStep : 1;
+	mEvaluationDuration = mCurrentGenerationStep * mStepSize;
 
-		CreatureBundle* a = new CreatureBundle(MutatedCreature, Scene, PlaneCollision);
+	for (auto Bundle : mCreatures)
+	{
+		/// Creatures that were skipped or stopped early already have their fitness, or get it from their twin below
+		if (Bundle->bFitnessKnown || Bundle->bTerminated)
+			continue;
 
-		mCreatures.push_back(a);
+		ScoreBundle(Bundle, EvaluationSteps);
+
+		if (bUseFitnessCache)
+			mFitnessCache[Bundle->mGenomeHash] = Bundle->mFitness;
 	}
 
-	MaterialPtr->release();
+	float BestFitness = 0;
+	for (auto Bundle : mCreatures)
+	{
+		if (Bundle->mFitnessSource != nullptr)
+		{
+			Bundle->mFitness = Bundle->mFitnessSource->mFitness;
+			Bundle->mAverageSpeed = Bundle->mFitnessSource->mAverageSpeed;
+			Bundle->bOutOfReach = Bundle->mFitnessSource->bOutOfReach;
+		}
+
+		if (Bundle->mFitness > BestFitness)
+			BestFitness = Bundle->mFitness;
+	}
+	mGenerationBestFitness.push_back(BestFitness);
 }
 
-void GenerationManager::LoadCreature(std::string FileName)
+void GenerationManager::CullAndMutateGeneration(int NumberToKeep, float MutationChance, float MutationSeverity)
 {
-	physx::PxShapeFlags ShapeFlags = physx::PxShapeFlag::eVISUALIZATION | physx::PxShapeFlag::eSCENE_QUERY_SHAPE | physx::PxShapeFlag::eSIMULATION_SHAPE;
-	physx::PxMaterial* MaterialPtr = mPhysics->createMaterial(0.5f, 0.5f, 0.1f);
+	/// Rank the creatures by index on their fitness alone, nothing about the creatures themselves needs to be touched to pick the survivors
+	std::vector<std::pair<int, float>> Ranking;
+	Ranking.reserve(mCreatures.size());
 
-	Creature* LoadedCreature = LoadCreatureFromFile(FileName, mPhysics, MaterialPtr, ShapeFlags, mCubeNode);
+	for (int i = 0; i < mCreatures.size(); i++)
+	{
+		Ranking.push_back({ i, mCreatures[i]->mFitness });
+	}
 
-	/// ----------------------------------------
-	/// [BEGIN] CREATURE PERSONAL SCENE SETUP
-	/// ----------------------------------------
+	/// Only the survivors need to be in order, ties go to the lower index so the ranking is the same as a stable sort
+	int NumberOfSurvivors = std::min(NumberToKeep, (int)Ranking.size());
+	std::partial_sort(Ranking.begin(), Ranking.begin() + NumberOfSurvivors, Ranking.end(),
+		[this](const std::pair<int, float>& A, const std::pair<int, float>& B)
+		{
+			if (RanksAbove(mCreatures[A.first], mCreatures[B.first]))
+				return true;
+			if (RanksAbove(mCreatures[B.first], mCreatures[A.first]))
+				return false;
+			return A.first < B.first;
+		});
+
+	/// The early stop rules use this to tell which creatures of the next generation can't make it anymore
+	if (NumberOfSurvivors > 0)
+		mSurvivorCutoff = Ranking[NumberOfSurvivors - 1].second;
+
+	/// Only the genomes of the survivors are kept for breeding, they're moved out since their creatures are deleted right after
+	std::vector<CreatureGenome> Survivors;
+	Survivors.reserve(NumberOfSurvivors);
+
+	for (int i = 0; i < NumberOfSurvivors; i++)
+	{
+		Survivors.push_back(std::move(mCreatures[Ranking[i].first]->mCreature->mGenome));
+	}
+
+	/// Delete the all of the CreatureBundle
+	for (int i = 0; i < mCreatures.size(); i++)
+	{
+		delete mCreatures[i];
+	}
+	mCreatures.erase(mCreatures.begin(), mCreatures.end());
+	bControllerBatchDirty = true;
 
-	physx::PxTolerancesScale ToleranceScale;
+	physx::PxShapeFlags ShapeFlags = physx::PxShapeFlag::eVISUALIZATION | physx::PxShapeFlag::eSCENE_QUERY_SHAPE | physx::PxShapeFlag::eSIMULATION_SHAPE;
+	physx::PxMaterial* MaterialPtr = mPhysics->createMaterial(0.5f, 0.5f, 0.1f);
 
-	ToleranceScale.length = 1;
-	ToleranceScale.speed = 981;
+	/// Refill the mCreatures array with creatures based on mutations from the fittest.
+	/// Mutating and building the articulations is spread over the worker threads, PxPhysics can create objects from several threads at once
+	std::vector<Creature*> Offspring(mGenerationSize);
 
-	physx::PxSceneDesc SceneDesc(ToleranceScale);
-	SceneDesc.gravity = { 0, -9.8, 0 };
-	SceneDesc.cpuDispatcher = mDispatcher;
-	SceneDesc.filterShader = physx::PxDefaultSimulationFilterShader;
-	SceneDesc.kineKineFilteringMode = physx::PxPairFilteringMode::eKEEP;
-	SceneDesc.staticKineFilteringMode = physx::PxPairFilteringMode::eKEEP;
+	ParallelFor(mGenerationSize, mBuildThreads, [&](int i)
+	{
+		ScopedRandomStream Stream(MakeCreatureStream(mRunSeed, mCurrentGeneration, i));
 
-	physx::PxScene* Scene = mPhysics->createScene(SceneDesc);
-	Scene->setFlag(physx::PxSceneFlag::eENABLE_ACTIVE_ACTORS, true);
+		CreatureGenome MutatedGenome = Survivors[i % Survivors.size()].GetMutated(MutationChance, MutationSeverity);
+		Offspring[i] = new Creature(MutatedGenome, mPhysics, MaterialPtr, ShapeFlags);
+	});
 
-	physx::PxRigidStatic* PlaneCollision = mPhysics->createRigidStatic(physx::PxTransformFromPlaneEquation(physx::PxPlane(physx::PxVec3(0.f, 1.f, 0.f), 0.f)));
+	/// Scenes are handed out by the pool in order, so the generation comes out the same however many threads built it
+	for (auto MutatedCreature : Offspring)
 	{
-		physx::PxShape* shape = mPhysics->createShape(physx::PxPlaneGeometry(), &MaterialPtr, 1, true, ShapeFlags);
-		PlaneCollision->attachShape(*shape);
-		shape->release();
+		AddCreatureToGeneration(MutatedCreature);
 	}
 
-	Scene->addActor(*PlaneCollision);
+	MaterialPtr->release();
+}
 
-	/// ----------------------------------------
-	/// [END] CREATURE PERSONAL SCENE SETUP
-	/// ----------------------------------------
+void GenerationManager::LoadCreature(std::string FileName)
+{
+	physx::PxShapeFlags ShapeFlags = physx::PxShapeFlag::eVISUALIZATION | physx::PxShapeFlag::eSCENE_QUERY_SHAPE | physx::PxShapeFlag::eSIMULATION_SHAPE;
+	physx::PxMaterial* MaterialPtr = mPhysics->createMaterial(0.5f, 0.5f, 0.1f);
 
-	CreatureBundle* Stats = new CreatureBundle(LoadedCreature, Scene, PlaneCollision);
+	Creature* LoadedCreature = LoadCreatureFromFile(FileName, mPhysics, MaterialPtr, ShapeFlags);
+
+	physx::PxScene* Scene = mScenePool.Acquire();
+
+	CreatureBundle* Stats = new CreatureBundle(LoadedCreature, Scene, &mScenePool);
 
 	LoadedCreature->AddToScene(Scene);
 
@@ -447,16 +898,6 @@ void GenerationManager::LoadCreature(std::string FileName)
 	MaterialPtr->release();
 }
 
-void GenerationManager::UpdateAndDrawLoadedCreatures(mat4 ViewProjection, float dt)
-{
-	for (auto Bundle : mLoadedCreatures)
-	{
-		Bundle->mLifetime += dt;
-		Bundle->mCreature->Update();
-		Bundle->mCreature->Draw(ViewProjection);
-	}
-}
-
 void GenerationManager::ActivateLoadedCreatures()
 {
 	for (auto Bundle : mLoadedCreatures)
@@ -479,11 +920,6 @@ void GenerationManager::RemoveLoadedCreature(int CreatureIndex)
 	/// Must be in range
 	assert(CreatureIndex >= 0 && CreatureIndex < mLoadedCreatures.size());
 
-	//mLoadedCreatures[CreatureIndex]->mCreature->RemoveFromScene(mLoadedCreatures[CreatureIndex]->mScene);
-	//delete mLoadedCreatures[CreatureIndex]->mCreature;
-	//mLoadedCreatures[CreatureIndex]->mScene->removeActor(*mLoadedCreatures[CreatureIndex]->mPlaneCollision);
-	//mLoadedCreatures[CreatureIndex]->mPlaneCollision->release();
-	//mLoadedCreatures[CreatureIndex]->mScene->release();
 	delete mLoadedCreatures[CreatureIndex];
 	mLoadedCreatures.erase(mLoadedCreatures.begin() + CreatureIndex);
 
@@ -2,39 +2,94 @@
 
 #include "config.h"
 #include "Creature.h"
+#include "ScenePool.h"
+#include "ControllerBatch.h"
+#include "PoseSnapshot.h"
+#include "RandomUtils.h"
 #include <PxPhysicsAPI.h>
 #include "render/GraphicsNode.h"
+#include <future>
+#include <cmath>
+#include <unordered_map>
 
 struct CreatureBundle
 {
 	Creature* mCreature;
 	float mFitness;
 	physx::PxScene* mScene;
-	physx::PxRigidStatic* mPlaneCollision;
+	/// The pool the scene was taken from, it is given back when the bundle is destroyed
+	ScenePool* mScenePool;
 	float mAverageSpeed;
 	float mSumHorizontalSpeed;
 	float mLifetime;
+	/// How many steps this creature has been evaluated for, only used by the steady state evolution where every creature has its own window
+	unsigned int mEvaluationSteps = 0;
+	/// Set once the creature has been scored in the steady state evolution, it isn't stepped or drawn until its offspring replaces it
+	bool bAwaitingReplacement = false;
+	/// Steady state only, how many steps the first window of the creature is held back. Staggering the windows across the population
+	/// keeps it from finishing all at once and being replaced in a single batch
+	unsigned int mStartDelaySteps = 0;
+	/// Set when the fitness of the genome is already known, from an earlier evaluation or from an identical creature in the same generation.
+	/// The creature isn't stepped or scored while the evolution is running
+	bool bFitnessKnown = false;
+	uint64_t mGenomeHash = 0;
+	/// Set when one of the early stop rules cut the evaluation short, the fitness is final from then on
+	bool bTerminated = false;
+	/// Set when it was the fitness bound that cut it short. The fitness is only the distance so far, so in the generational mode
+	/// the creature ranks below every creature that ran its whole window
+	bool bOutOfReach = false;
+	/// Where the root was the last time the stagnation rule looked, and at which evaluation step
+	physx::PxVec3 mStagnationAnchor = { 0, 0, 0 };
+	unsigned int mStagnationAnchorStep = 0;
+	/// The identical creature in the same generation that is evaluated in its place, its fitness is copied over when the evaluation ends
+	CreatureBundle* mFitnessSource = nullptr;
+	/// An inactive creature is paused, it isn't stepped, driven, updated or scored
 	bool bActive = true;
 	bool bDrawBoundingBox = false;
 
-	CreatureBundle(Creature* Crea, physx::PxScene* Scene, physx::PxRigidStatic* PlaneCollision)
+	CreatureBundle(Creature* Crea, physx::PxScene* Scene, ScenePool* Pool)
 	{
 		mCreature = Crea;
 		mFitness = 0;
 		mScene = Scene;
-		mPlaneCollision = PlaneCollision;
+		mScenePool = Pool;
 		mAverageSpeed = 0;
 		mSumHorizontalSpeed = 0;
 		mLifetime = 0;
 	}
 
+	/// Swaps the creature for a new one in the same scene and starts its stats over
+	void ReplaceCreature(Creature* NewCreature)
+	{
+		mCreature->RemoveFromScene(mScene);
+		delete mCreature;
+
+		mCreature = NewCreature;
+		mCreature->AddToScene(mScene);
+
+		mFitness = 0;
+		mAverageSpeed = 0;
+		mSumHorizontalSpeed = 0;
+		mLifetime = 0;
+		mEvaluationSteps = 0;
+		bAwaitingReplacement = false;
+		mStartDelaySteps = 0;
+		bFitnessKnown = false;
+		mFitnessSource = nullptr;
+		bTerminated = false;
+		bOutOfReach = false;
+		mStagnationAnchor = { 0, 0, 0 };
+		mStagnationAnchorStep = 0;
+	}
+
 	~CreatureBundle()
 	{
 		mCreature->RemoveFromScene(mScene);
 		delete mCreature;
-		mScene->removeActor(*mPlaneCollision);
-		mPlaneCollision->release();
-		mScene->release();
+
+		/// Bundles in the shared scene don't have a pool to give it back to
+		if (mScenePool != nullptr)
+			mScenePool->Release(mScene);
 	}
 
 };
@@ -46,6 +101,55 @@ enum GenerationManagerState {
 	Waiting,
 };
 
+enum class CreatureSceneMode {
+	/// Every creature gets a scene of its own
+	PersonalScenes,
+	/// The whole generation lives in one scene, with a filter shader that stops creatures from colliding with each other
+	SharedScene,
+};
+
+enum class EvolutionMode {
+	/// The whole population is evaluated together, then culled and refilled at once
+	Generational,
+	/// Every creature is replaced by the offspring of an elite as soon as its own evaluation window is over, so there is no gap between generations.
+	/// A generation is counted every mGenerationSize evaluations
+	SteadyState,
+};
+
+/// Rules for giving up on a creature before its evaluation window is over, so the steps go to the rest of the population instead
+struct EarlyStopRules
+{
+	bool bEnabled = false;
+
+	/// A creature whose root moves less than this horizontally over the window is taken to have stopped, 0 steps turns the rule off
+	unsigned int mStagnationWindowSteps = 180;
+	float mStagnationDistance = 0.25f;
+	/// Creatures are dropped in from above, so they aren't expected to go anywhere before they have landed
+	unsigned int mStagnationGraceSteps = 300;
+
+	/// Past either of these, or with a root pose that isn't finite, the simulation of the creature has blown up and it gets a NaN fitness
+	float mExplosionDistance = 1000.0f;
+	float mExplosionSpeed = 200.0f;
+
+	/// Stops a creature that couldn't reach the survivor cutoff even if it moved straight away from the spawn at this speed for the rest of the window.
+	/// The speed is an assumed limit, not one derived from the physics, so a creature that would have sped up past it can be stopped by mistake.
+	/// In the generational mode the cutoff comes from the previous generation, so stopped creatures are ranked below the ones that finished
+	bool bUseFitnessBound = true;
+	float mMaxHorizontalSpeed = 20.0f;
+};
+
+/// An offspring that is being built in the background for the steady state evolution
+struct PendingOffspring
+{
+	/// The bundle whose creature it replaces
+	int mBundleIndex;
+	CreatureGenome mParent;
+	/// Already used to pick the parent, the mutation carries on from there
+	RandomStream mStream;
+	/// Filled in by the builder
+	Creature* mCreature = nullptr;
+};
+
 class GenerationManager
 {
 public:
@@ -56,6 +160,57 @@ public:
 	physx::PxPhysics* mPhysics;
 	physx::PxDefaultCpuDispatcher* mDispatcher = NULL;
 
+	/// Owns every creature scene, they are reused between generations instead of being recreated
+	ScenePool mScenePool;
+
+	/// When set every scene is started before any results are fetched, so the dispatcher can step them in parallel
+	bool bParallelStepping = true;
+
+	/// The controllers of every creature in mCreatures, rebuilt by Activate whenever the generation has changed
+	ControllerBatch mControllerBatch;
+	std::vector<float> mControllerLifetimes;
+	/// Creatures that aren't being stepped don't get their targets pushed, that would wake them up
+	std::vector<uint8_t> mControllerActive;
+	bool bControllerBatchDirty = true;
+
+	/// How many threads build the creatures of a new generation, 0 uses one per core and 1 builds them all on the calling thread
+	unsigned int mBuildThreads = 0;
+
+	/// Should only be changed while there's no evolution running, like mSceneMode
+	EvolutionMode mEvolutionMode = EvolutionMode::Generational;
+
+	/// The evaluation is deterministic, so a genome that has been evaluated before doesn't need to be simulated again.
+	/// Maps the hash of every genome evaluated since Start to the fitness it got
+	bool bUseFitnessCache = true;
+	std::unordered_map<uint64_t, float> mFitnessCache;
+	/// How many creatures got their fitness from the cache or from an identical creature since Start, instead of being evaluated
+	unsigned int mFitnessCacheHits = 0;
+
+	/// Steady state only, how many steps after being queued the offspring are swapped in, the builder waits for that long at most.
+	/// It is counted in steps and not in wall time so that a run still only depends on its seed
+	unsigned int mBreedLatencySteps = 30;
+	/// The best genomes ever evaluated in the steady state evolution, best first, parents are drawn from these
+	std::vector<std::pair<CreatureGenome, float>> mElites;
+	std::vector<PendingOffspring> mPendingOffspring;
+	std::future<void> mBreedTask;
+	physx::PxMaterial* mBreedMaterial = nullptr;
+	unsigned int mBreedInstallStep = 0;
+	/// Every step and every evaluation since Start, the count of offspring is what their random streams are made from
+	unsigned int mStepsSinceStart = 0;
+	unsigned int mEvaluationCount = 0;
+	unsigned int mOffspringCount = 0;
+	float mCurrentGenerationBestFitness = 0;
+
+	EarlyStopRules mEarlyStop;
+	/// The fitness a creature needs to be kept, in the generational mode it's the worst survivor of the previous generation
+	float mSurvivorCutoff = -INFINITY;
+	/// How many creatures had their evaluation cut short since Start
+	unsigned int mEarlyStopCount = 0;
+
+	/// Which kind of scene the generation is simulated in, should only be changed while there's no evolution running
+	CreatureSceneMode mSceneMode = CreatureSceneMode::PersonalScenes;
+
+	/// Every creature part is built with this node, pose snapshots point at its meshes instead of holding references of their own
 	GraphicsNode mCubeNode;
 
 	GenerationManagerState mCurrentState = GenerationManagerState::Nothing;
@@ -66,15 +221,28 @@ public:
 	float mGenerationDurationSeconds = 60.0f;
 	float mCurrentGenerationDuration = 0.0f;
 
+	/// Fixed size of a physics step, the evaluation window is counted in these so fitness doesn't depend on how fast the machine is
+	float mStepSize = 1.0f / 60.0f;
+	unsigned int mGenerationDurationSteps = 0;
+	unsigned int mCurrentGenerationStep = 0;
+
+	/// Every random creature and every mutation draws from a stream made from this, the generation and its index, so a run can be repeated from its seed
+	uint64_t mRunSeed = 0;
+
+	/// At least 1 once started
 	int mGenerationSurvivors = 0; 
 	float mMutationChance = 0; 
 	float mMutationSeverity = 0;
 
-	/// Variables for keeping track of how long an evaluation period was, in seconds
-	std::chrono::steady_clock::time_point mEvaluationStartTime;
+	/// How long the last evaluation period was, in simulated seconds
 	float mEvaluationDuration = 0;
 
 	std::vector<std::pair<Creature*, float>> mSortedCreatures;
+	/// The creature in mSortedCreatures that was drawn last, the others are left alone once the evolution is finished
+	int mDisplayedCreatureIndex = -1;
+
+	/// The best fitness reached in each evaluated generation, in order
+	std::vector<float> mGenerationBestFitness;
 
 	/// These are not part of the generations, they are loaded in from file by the user
 	std::vector<CreatureBundle*> mLoadedCreatures;
@@ -82,19 +250,43 @@ public:
 
 /// METHODS
 	GenerationManager(physx::PxPhysics* Physics, physx::PxDefaultCpuDispatcher* Dispatcher, GraphicsNode CubeNode);
+	~GenerationManager();
 
 	/// This will populate the vector above with creatures and scenes with a plane, with mGenerationSize amount of creatures
 	void GenerateCreatures(int GenerationSize, bool bUseLoadedCreatures);
 
+	/// Puts the creature in a scene according to mSceneMode and adds it to the generation
+	void AddCreatureToGeneration(Creature* NewCreature);
+
+	/// Looks the creature's genome up in the fitness cache, and among the creatures in front of it in the generation when FirstWithHash is given
+	void FindKnownFitness(CreatureBundle* Bundle, std::unordered_map<uint64_t, CreatureBundle*>* FirstWithHash);
+	/// False for creatures that are inactive or aren't being evaluated right now, those aren't stepped, driven, updated, drawn or scored
+	bool NeedsStepping(const CreatureBundle* Bundle) const;
+	/// Puts the creature's articulation to sleep or wakes it up to match NeedsStepping, only matters in the shared scene
+	void UpdateSleepState(CreatureBundle* Bundle);
+
 	void Simulate(float StepSize);
-	void UpdateCreatures(float dt);
-	void DrawCreatures(mat4 ViewProjection, std::shared_ptr<ShaderResource> Shader = nullptr);
-	void DrawFinishedCreatures(mat4 ViewProjection, int CreatureIndex);
+	/// Reads the root state of the creature and adds its horizontal speed to the running sum, the sum only grows while a generation is being evaluated.
+	/// The early stop rules are checked here as well
+	void AccumulateSpeed(CreatureBundle* Bundle);
+	/// Ends the evaluation of the creature if it broke one of the rules in mEarlyStop, returns true if it did
+	bool CheckEarlyStop(CreatureBundle* Bundle);
+	/// Copies the pose of every creature that should be drawn into the snapshot: the ones still being evaluated,
+	/// the one being looked at once the evolution is finished, and the loaded ones. Must be called from the thread that steps the creatures
+	void WritePoseSnapshot(PoseSnapshot& Snapshot);
+	/// Picks which of mSortedCreatures is looked at and simulated once the evolution is finished
+	void SetDisplayedCreature(int CreatureIndex);
+	/// How far the creature has come so far, the same measure as its fitness once the evaluation is over
+	float GetRunningFitness(const CreatureBundle* Bundle) const;
 	void SetPositionOfCreatures(vec3 Position);
 	void Activate();
 
 	void Start(int NumberOfGenerations, float GenTime, int GenerationSurvivors, float MutationChance, float MutationSeverity, int GenerationSize, bool bUseLoadedCreatures);
-	void Update(float DeltaTime);
+	/// Ends the current generation once it has been simulated for the full evaluation window
+	void Update();
+
+	/// Advances the evolution by a single physics step of mStepSize, for when there is no render loop driving the generation manager
+	void Tick();
 
 	void StartEvalutation();
 	void EndEvaluation();
@@ -102,8 +294,20 @@ public:
 	/// This is the fundamental method of this class, that will
 	void CullAndMutateGeneration(int NumberToKeep, float MutationChance, float MutationSeverity);
 
+	/// The steady state counterpart of the generation boundary, called every step: swaps in finished offspring, scores creatures
+	/// whose window is over and queues their replacements
+	void UpdateSteadyState();
+	void InstallOffspring();
+	void QueueOffspring();
+	/// Waits for any offspring still being built and throws them away
+	void DiscardOffspring();
+	/// Puts the elites in place of the population once the steady state evolution is done, so they can be looked through like a finished generation
+	void FinishSteadyState();
+
+	/// Fills mSortedCreatures from mCreatures, best first
+	void SortFinishedCreatures();
+
 	void LoadCreature(std::string FileName);
-	void UpdateAndDrawLoadedCreatures(mat4 ViewProjection, float dt);
 	void SetLoadedCreaturePosition(int CreatureIndex, vec3 Position);
 	void RemoveLoadedCreature(int CreatureIndex);
 	void ActivateLoadedCreatures();
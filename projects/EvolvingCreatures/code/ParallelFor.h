@@ -0,0 +1,34 @@
+#pragma once
+
+#include "config.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/// Runs Task(i) for every i from 0 up to Count spread over NumThreads threads, the calling thread is one of them.
+/// Indices are handed out one at a time so a few slow tasks don't hold up a whole thread's share. 0 threads means one per core
+template <typename TaskType>
+void ParallelFor(int Count, unsigned int NumThreads, const TaskType& Task)
+{
+	if (NumThreads == 0)
+		NumThreads = std::max(1u, std::thread::hardware_concurrency());
+	NumThreads = std::min(NumThreads, (unsigned int)std::max(Count, 1));
+
+	std::atomic<int> NextIndex = 0;
+	auto Worker = [&]()
+	{
+		for (int i = NextIndex++; i < Count; i = NextIndex++)
+			Task(i);
+	};
+
+	std::vector<std::thread> Threads;
+	Threads.reserve(NumThreads - 1);
+	for (unsigned int i = 1; i < NumThreads; i++)
+		Threads.emplace_back(Worker);
+
+	Worker();
+
+	for (auto& Thread : Threads)
+		Thread.join();
+}
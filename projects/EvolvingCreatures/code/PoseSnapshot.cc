@@ -0,0 +1,165 @@
+#include "PoseSnapshot.h"
+#include "Creature.h"
+#include <algorithm>
+
+void PoseSnapshot::Clear()
+{
+	mCreatures.clear();
+	mPoses.clear();
+	mScales.clear();
+	mBoundingBoxes.clear();
+	mDisplayedCreature = -1;
+}
+
+void PoseSnapshot::AddCreature(const Creature& CreatureToAdd, const std::vector<std::shared_ptr<MeshResource>>* Meshes, float RunningFitness, bool bWithBoundingBoxes)
+{
+	CreatureEntry& Entry = mCreatures.emplace_back();
+	Entry.mCreatureId = CreatureToAdd.mId;
+	Entry.mFirstPart = mPoses.size();
+	Entry.mNumParts = CreatureToAdd.mParts.size();
+	Entry.mRunningFitness = RunningFitness;
+	Entry.mMeshes = Meshes;
+
+	for (const CreaturePart& Part : CreatureToAdd.mParts)
+	{
+		mPoses.push_back(Part.mLink->getGlobalPose());
+		mScales.push_back(Part.mScale);
+	}
+
+	Entry.mFirstBox = mBoundingBoxes.size();
+	if (bWithBoundingBoxes)
+		CreatureToAdd.GetBoundingBoxTransforms(mBoundingBoxes);
+	Entry.mNumBoxes = mBoundingBoxes.size() - Entry.mFirstBox;
+}
+
+PoseSnapshot& PoseSnapshotBuffer::GetWriteSnapshot()
+{
+	return mBack;
+}
+
+void PoseSnapshotBuffer::Publish()
+{
+	std::lock_guard<std::mutex> Lock(mMutex);
+	mBack.mVersion = mLatestVersion + 1;
+	std::swap(mFront, mBack);
+	mLatestVersion = mFront.mVersion;
+}
+
+void PoseSnapshotBuffer::ReadLatest(PoseSnapshot& Out)
+{
+	std::lock_guard<std::mutex> Lock(mMutex);
+	Out = mFront;
+}
+
+bool PoseSnapshotReader::Refresh(PoseSnapshotBuffer& Buffer)
+{
+	if (Buffer.mLatestVersion == mCurrent.mVersion)
+		return false;
+
+	std::swap(mPrevious, mCurrent);
+	Buffer.ReadLatest(mCurrent);
+	mCurrentReadTime = std::chrono::high_resolution_clock::now();
+
+	mPreviousIndices.clear();
+	for (unsigned int i = 0; i < mPrevious.mCreatures.size(); i++)
+		mPreviousIndices[mPrevious.mCreatures[i].mCreatureId] = i;
+
+	return true;
+}
+
+float PoseSnapshotReader::GetAlpha() const
+{
+	double Interval = mCurrent.mSimulatedTime - mPrevious.mSimulatedTime;
+	if (!bInterpolate || mPrevious.mVersion == 0 || Interval <= 0)
+		return 1;
+
+	/// Drawing one snapshot behind the simulation, the time since the latest one arrived is how far to move towards it
+	double Elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - mCurrentReadTime).count();
+	return (float)std::min(Elapsed / Interval, 1.0);
+}
+
+/// Linear for the position and normalized linear for the rotation, the two poses are only ever a step or two apart
+static physx::PxTransform InterpolatePose(const physx::PxTransform& From, const physx::PxTransform& To, float Alpha)
+{
+	physx::PxQuat ToRotation = To.q;
+	/// q and -q are the same rotation, take the one closest to From so it doesn't turn the long way around
+	if (From.q.dot(ToRotation) < 0)
+		ToRotation = -ToRotation;
+
+	physx::PxQuat Rotation = From.q * (1 - Alpha) + ToRotation * Alpha;
+	return physx::PxTransform(From.p + (To.p - From.p) * Alpha, Rotation.getNormalized());
+}
+
+void PoseSnapshotReader::Gather(DrawList& List, const Frustum* PassFrustums)
+{
+	mCreaturesGathered = 0;
+	mCreaturesCulled = 0;
+
+	mCandidates.clear();
+	for (unsigned int i = 0; i < mCurrent.mCreatures.size(); i++)
+		mCandidates.push_back(i);
+
+	/// Only the leaders are interesting to look at in a big population, so pick them out without sorting the rest
+	if (mRenderTopK > 0 && mCandidates.size() > (size_t)mRenderTopK)
+	{
+		std::nth_element(mCandidates.begin(), mCandidates.begin() + mRenderTopK, mCandidates.end(),
+			[this](unsigned int a, unsigned int b) { return mCurrent.mCreatures[a].mRunningFitness > mCurrent.mCreatures[b].mRunningFitness; });
+		mCandidates.resize(mRenderTopK);
+	}
+
+	float Alpha = GetAlpha();
+
+	for (unsigned int Index : mCandidates)
+	{
+		const PoseSnapshot::CreatureEntry& Entry = mCurrent.mCreatures[Index];
+
+		/// Creatures that weren't in the previous snapshot, or were rebuilt since, are drawn where they are now
+		const PoseSnapshot::CreatureEntry* PreviousEntry = nullptr;
+		if (Alpha < 1)
+		{
+			auto Found = mPreviousIndices.find(Entry.mCreatureId);
+			if (Found != mPreviousIndices.end() && mPrevious.mCreatures[Found->second].mNumParts == Entry.mNumParts)
+				PreviousEntry = &mPrevious.mCreatures[Found->second];
+		}
+
+		vec3 BoundsMin, BoundsMax;
+		mTransforms.resize(Entry.mNumParts);
+		for (unsigned int Part = 0; Part < Entry.mNumParts; Part++)
+		{
+			physx::PxTransform Pose = mCurrent.mPoses[Entry.mFirstPart + Part];
+			if (PreviousEntry != nullptr)
+				Pose = InterpolatePose(mPrevious.mPoses[PreviousEntry->mFirstPart + Part], Pose, Alpha);
+
+			mTransforms[Part] = CreaturePart::MakeTransform(Pose, mCurrent.mScales[Entry.mFirstPart + Part]);
+
+			vec3 PartMin, PartMax;
+			CreaturePart::GetTransformBounds(mTransforms[Part], PartMin, PartMax);
+			for (int Axis = 0; Axis < 3; Axis++)
+			{
+				BoundsMin[Axis] = Part == 0 ? PartMin[Axis] : std::min(BoundsMin[Axis], PartMin[Axis]);
+				BoundsMax[Axis] = Part == 0 ? PartMax[Axis] : std::max(BoundsMax[Axis], PartMax[Axis]);
+			}
+		}
+
+		uint32_t PassMask = AllRenderPasses;
+		if (PassFrustums != nullptr)
+		{
+			PassMask = 0;
+			for (int Pass = 0; Pass < (int)RenderPass::Count; Pass++)
+			{
+				if (PassFrustums[Pass].IsBoxVisible(BoundsMin, BoundsMax))
+					PassMask |= 1u << Pass;
+			}
+		}
+
+		if (PassMask == 0)
+		{
+			mCreaturesCulled++;
+			continue;
+		}
+
+		for (const mat4& Transform : mTransforms)
+			List.AddMeshes(*Entry.mMeshes, Transform, PassMask);
+		mCreaturesGathered++;
+	}
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "config.h"
+#include "render/DrawList.h"
+#include "render/Frustum.h"
+#include <PxPhysicsAPI.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class Creature;
+
+/// The pose of every creature that should be drawn, copied out of PhysX after a simulation step.
+/// Holds everything needed to draw the creatures, so the render thread never has to touch PhysX or the creatures themselves
+class PoseSnapshot
+{
+public:
+	struct CreatureEntry
+	{
+		/// Tells the same creature apart in two snapshots, for interpolating between them
+		uint64_t mCreatureId;
+		/// The parts are mPoses[mFirstPart] up to mPoses[mFirstPart + mNumParts], root first
+		unsigned int mFirstPart;
+		unsigned int mNumParts;
+		/// How far along the creature was, for picking which creatures to draw
+		float mRunningFitness;
+		/// Every part of a creature is drawn with the same meshes. Owned by the generation manager, which outlives every snapshot,
+		/// so copying a snapshot doesn't have to touch the reference counts
+		const std::vector<std::shared_ptr<MeshResource>>* mMeshes;
+		/// The boxes of its genome are mBoundingBoxes[mFirstBox] up to mBoundingBoxes[mFirstBox + mNumBoxes], none unless they were asked for
+		unsigned int mFirstBox;
+		unsigned int mNumBoxes;
+	};
+
+	std::vector<CreatureEntry> mCreatures;
+	std::vector<physx::PxTransform> mPoses;
+	std::vector<vec3> mScales;
+	/// Relative to where the creatures spawn
+	std::vector<mat4> mBoundingBoxes;
+	/// The creature in mCreatures that is being looked at once the evolution is finished, -1 if there is none
+	int mDisplayedCreature = -1;
+
+	/// Simulated seconds at the time of the snapshot
+	double mSimulatedTime = 0;
+	/// 0 for a snapshot that was never published
+	uint64_t mVersion = 0;
+
+	/// Keeps the storage so the next snapshot can reuse it
+	void Clear();
+	/// Reads the global pose of every link of the creature, must be called from the thread that steps it.
+	/// Meshes is what every part is drawn with and has to outlive the snapshot
+	void AddCreature(const Creature& CreatureToAdd, const std::vector<std::shared_ptr<MeshResource>>* Meshes, float RunningFitness, bool bWithBoundingBoxes = false);
+};
+
+/// Hands snapshots from the simulation thread to the render thread.
+/// The simulation fills the back snapshot at its own pace and swaps it to the front when complete, readers only ever see complete snapshots
+class PoseSnapshotBuffer
+{
+public:
+	std::mutex mMutex;
+	PoseSnapshot mFront;
+	PoseSnapshot mBack;
+	std::atomic<uint64_t> mLatestVersion = 0;
+
+	/// Only the simulation thread may touch this between calls to Publish
+	PoseSnapshot& GetWriteSnapshot();
+	void Publish();
+
+	/// Copies the latest complete snapshot into Out, the copy keeps Out's storage
+	void ReadLatest(PoseSnapshot& Out);
+};
+
+/// The render thread's side: keeps the two latest snapshots and records the creatures in them into a draw list,
+/// optionally interpolated between the two so the motion is smooth when frames and steps don't line up
+class PoseSnapshotReader
+{
+public:
+	PoseSnapshot mPrevious;
+	PoseSnapshot mCurrent;
+	/// When mCurrent was read, the time since then decides how far between mPrevious and mCurrent to draw
+	std::chrono::high_resolution_clock::time_point mCurrentReadTime;
+	/// Where each creature in mPrevious is, by id
+	std::unordered_map<uint64_t, unsigned int> mPreviousIndices;
+
+	bool bInterpolate = true;
+	/// Only this many of the creatures furthest along are drawn, 0 draws all of them
+	int mRenderTopK = 0;
+
+	/// Creatures recorded into the draw list and creatures left out because no pass could see them, during the last Gather
+	unsigned int mCreaturesGathered = 0;
+	unsigned int mCreaturesCulled = 0;
+
+	/// Scratch space
+	std::vector<unsigned int> mCandidates;
+	std::vector<mat4> mTransforms;
+
+	/// Takes the latest snapshot if there is a new one, returns true if there was
+	bool Refresh(PoseSnapshotBuffer& Buffer);
+	/// How far from mPrevious to mCurrent to draw, 1 draws mCurrent as it is
+	float GetAlpha() const;
+
+	/// PassFrustums holds what each pass can see, indexed by RenderPass, creatures outside all of them aren't recorded. Null records everything
+	void Gather(DrawList& List, const Frustum* PassFrustums);
+};
@@ -3,12 +3,82 @@
 #include "config.h"
 #include <random>
 
+/// A PCG32 generator, small and fast with independent streams, so every creature, generation and thread can get a sequence of its own.
+/// Two streams built from the same values always give the same numbers, which is what makes a run reproducible from its seed
+class RandomStream
+{
+public:
+	uint64_t mState = 0;
+	uint64_t mIncrement = 1;
+
+	RandomStream(uint64_t Seed = 0x853c49e6748fea9bULL, uint64_t Stream = 0xda3e39cb94b95bdbULL)
+	{
+		/// The increment has to be odd, every distinct stream value gives a different sequence
+		mIncrement = (Stream << 1u) | 1u;
+		Next();
+		mState += Seed;
+		Next();
+	}
+
+	uint32_t Next()
+	{
+		uint64_t OldState = mState;
+		mState = OldState * 6364136223846793005ULL + mIncrement;
+		uint32_t XorShifted = (uint32_t)(((OldState >> 18u) ^ OldState) >> 27u);
+		uint32_t Rotation = (uint32_t)(OldState >> 59u);
+		return (XorShifted >> Rotation) | (XorShifted << ((-Rotation) & 31));
+	}
+};
+
+/// SplitMix64, spreads out seeds that only differ by a little so neighbouring streams don't start out correlated
+inline static uint64_t MixSeed(uint64_t Value)
+{
+	Value += 0x9e3779b97f4a7c15ULL;
+	Value = (Value ^ (Value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	Value = (Value ^ (Value >> 27)) * 0x94d049bb133111ebULL;
+	return Value ^ (Value >> 31);
+}
+
+/// The stream used for one creature in one generation of a run, it doesn't matter which thread it ends up being used on
+inline static RandomStream MakeCreatureStream(uint64_t RunSeed, uint32_t Generation, uint32_t CreatureIndex)
+{
+	return RandomStream(MixSeed(RunSeed ^ MixSeed(Generation)), CreatureIndex);
+}
+
+/// Every thread draws from its own stream, the helpers below always use the one belonging to the calling thread
+inline thread_local RandomStream ThreadRandomStream;
+
+/// Restarts the calling thread's stream from the seed
+inline static void SeedRandom(uint64_t Seed)
+{
+	ThreadRandomStream = RandomStream(MixSeed(Seed));
+}
+
+/// Swaps in a stream for the calling thread while it's alive and puts the old one back after, wrap anything that should be reproducible in one of these
+class ScopedRandomStream
+{
+public:
+	RandomStream mPrevious;
+
+	ScopedRandomStream(const RandomStream& Stream) : mPrevious(ThreadRandomStream)
+	{
+		ThreadRandomStream = Stream;
+	}
+
+	~ScopedRandomStream()
+	{
+		ThreadRandomStream = mPrevious;
+	}
+};
+
+/// From 0 up to Mult
 inline static float RandomFloat(float Mult = 1)
 {
-	return Mult * (float(rand()) / float(RAND_MAX));
+	/// The top 24 bits are all a float can hold exactly
+	return Mult * (float(ThreadRandomStream.Next() >> 8) * (1.0f / 16777216.0f));
 }
 
-/// Inclusive, will potentially return Min or Max
+/// Will potentially return Min, and Max only through rounding
 inline static float RandomFloatInRange(float Min, float Max)
 {
 	float x = RandomFloat(Max - Min) + Min;
@@ -19,7 +89,21 @@ inline static float RandomFloatInRange(float Min, float Max)
 ///  Exclusive, will never return Max
 inline static int RandomInt(int Max)
 {
-	return rand() % Max;
+	assert(Max > 0);
+
+	/// Lemire's multiply and shift, values that would make some results more likely than others are thrown away
+	uint64_t Product = (uint64_t)ThreadRandomStream.Next() * (uint32_t)Max;
+	uint32_t Low = (uint32_t)Product;
+	if (Low < (uint32_t)Max)
+	{
+		uint32_t Threshold = (0u - (uint32_t)Max) % (uint32_t)Max;
+		while (Low < Threshold)
+		{
+			Product = (uint64_t)ThreadRandomStream.Next() * (uint32_t)Max;
+			Low = (uint32_t)Product;
+		}
+	}
+	return (int)(Product >> 32);
 }
 
 inline static int RandomIntInRange(int Min, int Max)
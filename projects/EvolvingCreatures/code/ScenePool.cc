@@ -0,0 +1,100 @@
+#include "ScenePool.h"
+
+/// Word1 of the filter data holds the id of the creature a shape belongs to, the ground keeps the default of 0 so it collides with everyone.
+/// Shapes from two different creatures never collide, everything else behaves like the default filter shader.
+/// Word0 is left at 0 since the default shader uses it to index its 32x32 collision group table, word1 is never read by it
+static physx::PxFilterFlags CreatureFilterShader(physx::PxFilterObjectAttributes Attributes0, physx::PxFilterData FilterData0, 
+	physx::PxFilterObjectAttributes Attributes1, physx::PxFilterData FilterData1, physx::PxPairFlags& PairFlags, const void* ConstantBlock, physx::PxU32 ConstantBlockSize)
+{
+	if (FilterData0.word1 != 0 && FilterData1.word1 != 0 && FilterData0.word1 != FilterData1.word1)
+		return physx::PxFilterFlag::eKILL;
+
+	return physx::PxDefaultSimulationFilterShader(Attributes0, FilterData0, Attributes1, FilterData1, PairFlags, ConstantBlock, ConstantBlockSize);
+}
+
+ScenePool::ScenePool(physx::PxPhysics* Physics, physx::PxCpuDispatcher* Dispatcher) : mPhysics(Physics), mDispatcher(Dispatcher)
+{
+	physx::PxShapeFlags ShapeFlags = physx::PxShapeFlag::eVISUALIZATION | physx::PxShapeFlag::eSCENE_QUERY_SHAPE | physx::PxShapeFlag::eSIMULATION_SHAPE;
+
+	mGroundMaterial = mPhysics->createMaterial(0.5f, 0.5f, 0.1f);
+
+	/// Not exclusive, so that the same shape can be attached to the ground plane of every scene
+	mGroundShape = mPhysics->createShape(physx::PxPlaneGeometry(), &mGroundMaterial, 1, false, ShapeFlags);
+}
+
+ScenePool::~ScenePool()
+{
+	/// All scenes should have been given back by now
+	assert(mFreeScenes.size() + (mSharedScene != nullptr) == mScenes.size());
+
+	for (auto& [Scene, PlaneCollision] : mScenes)
+	{
+		Scene->removeActor(*PlaneCollision);
+		PlaneCollision->release();
+		Scene->release();
+	}
+
+	mGroundShape->release();
+	mGroundMaterial->release();
+}
+
+physx::PxScene* ScenePool::Acquire()
+{
+	if (mFreeScenes.size() == 0)
+		return CreateScene();
+
+	physx::PxScene* Scene = mFreeScenes.back();
+	mFreeScenes.pop_back();
+	return Scene;
+}
+
+void ScenePool::Release(physx::PxScene* Scene)
+{
+	mFreeScenes.push_back(Scene);
+}
+
+physx::PxScene* ScenePool::GetSharedScene()
+{
+	if (mSharedScene == nullptr)
+		mSharedScene = CreateScene(CreatureFilterShader);
+
+	return mSharedScene;
+}
+
+physx::PxScene* ScenePool::CreateScene(physx::PxSimulationFilterShader FilterShader)
+{
+	/// ----------------------------------------
+	/// [BEGIN] CREATURE PERSONAL SCENE SETUP
+	/// ----------------------------------------
+
+	physx::PxTolerancesScale ToleranceScale;
+
+	ToleranceScale.length = 1;
+	ToleranceScale.speed = 981;
+
+	physx::PxSceneDesc SceneDesc(ToleranceScale);
+	SceneDesc.gravity = { 0, -9.8, 0 };
+	SceneDesc.cpuDispatcher = mDispatcher;
+	SceneDesc.filterShader = FilterShader;
+	SceneDesc.kineKineFilteringMode = physx::PxPairFilteringMode::eKEEP;
+	SceneDesc.staticKineFilteringMode = physx::PxPairFilteringMode::eKEEP;
+	/// The fitness cache and the twins in a generation take an unchanged genome to score the same every time. Without this the result
+	/// of an island can depend on what else is in the scene, which matters most in the shared scene where the whole generation is
+	SceneDesc.flags = SceneDesc.flags | physx::PxSceneFlag::eENABLE_ENHANCED_DETERMINISM;
+
+	physx::PxScene* Scene = mPhysics->createScene(SceneDesc);
+	Scene->setFlag(physx::PxSceneFlag::eENABLE_ACTIVE_ACTORS, true);
+
+	physx::PxRigidStatic* PlaneCollision = mPhysics->createRigidStatic(physx::PxTransformFromPlaneEquation(physx::PxPlane(physx::PxVec3(0.f, 1.f, 0.f), 0.f)));
+	PlaneCollision->attachShape(*mGroundShape);
+
+	Scene->addActor(*PlaneCollision);
+
+	/// ----------------------------------------
+	/// [END] CREATURE PERSONAL SCENE SETUP
+	/// ----------------------------------------
+
+	mScenes.push_back({ Scene, PlaneCollision });
+
+	return Scene;
+}
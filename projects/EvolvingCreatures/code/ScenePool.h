@@ -0,0 +1,40 @@
+#pragma once
+
+#include "config.h"
+#include <PxPhysicsAPI.h>
+#include <vector>
+
+/// Keeps the personal creature scenes, ground plane included, alive across generations so that they don't have to be created and released for every creature.
+/// Creatures are swapped in and out of the scenes instead.
+class ScenePool
+{
+public:
+	physx::PxPhysics* mPhysics;
+	physx::PxCpuDispatcher* mDispatcher;
+
+	physx::PxMaterial* mGroundMaterial;
+	/// A single plane shape that is shared by the ground of every scene
+	physx::PxShape* mGroundShape;
+
+	/// Every scene the pool has created along with its ground plane, so they can be released at the end
+	std::vector<std::pair<physx::PxScene*, physx::PxRigidStatic*>> mScenes;
+	std::vector<physx::PxScene*> mFreeScenes;
+
+	/// One scene for a whole population, only created if something asks for it
+	physx::PxScene* mSharedScene = nullptr;
+
+	ScenePool(physx::PxPhysics* Physics, physx::PxCpuDispatcher* Dispatcher);
+	~ScenePool();
+
+	/// Hands out a scene that only contains a ground plane, a new one is only created if there are none free
+	physx::PxScene* Acquire();
+
+	/// Gives a scene back to the pool, anything that was added to it besides the ground plane must be removed first
+	void Release(physx::PxScene* Scene);
+
+	/// The scene that a whole population can share, creatures in it only collide with the ground and themselves.
+	/// Each creature needs its own id in word1 of the simulation filter data of its shapes for this to work, see Creature::SetCollisionGroup
+	physx::PxScene* GetSharedScene();
+
+	physx::PxScene* CreateScene(physx::PxSimulationFilterShader FilterShader = physx::PxDefaultSimulationFilterShader);
+};
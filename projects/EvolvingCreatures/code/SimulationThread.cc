@@ -0,0 +1,139 @@
+#include "SimulationThread.h"
+#include <chrono>
+
+SimulationThread::SimulationThread(GenerationManager* GenMan, unsigned int MaxStepsPerFrame) : mGenMan(GenMan), mScheduler(GenMan->mStepSize, MaxStepsPerFrame)
+{
+	/// Intentionally left blank
+}
+
+SimulationThread::~SimulationThread()
+{
+	Stop();
+}
+
+void SimulationThread::Start()
+{
+	assert(!bRunning);
+	bRunning = true;
+	mThread = std::thread(&SimulationThread::Run, this);
+}
+
+void SimulationThread::Stop()
+{
+	bRunning = false;
+	if (mThread.joinable())
+		mThread.join();
+}
+
+void SimulationThread::Enqueue(Command NewCommand)
+{
+	std::lock_guard<std::mutex> Lock(mCommandMutex);
+	mCommands.push_back(std::move(NewCommand));
+}
+
+void SimulationThread::ReadStatus(SimulationStatus& Out)
+{
+	if (mStatusVersion == Out.mVersion)
+		return;
+
+	std::lock_guard<std::mutex> Lock(mStatusMutex);
+	Out = mStatus;
+}
+
+void SimulationThread::Step()
+{
+	if (mGenMan->mCurrentState != GenerationManagerState::Waiting)
+		mGenMan->Activate();
+
+	if (mGenMan->mCurrentState == GenerationManagerState::Nothing)
+		mGenMan->ActivateLoadedCreatures();
+
+	mGenMan->Simulate(mScheduler.mStepSize);
+	mGenMan->Update();
+}
+
+bool SimulationThread::RunCommands()
+{
+	{
+		std::lock_guard<std::mutex> Lock(mCommandMutex);
+		std::swap(mCommands, mRunningCommands);
+	}
+
+	for (Command& QueuedCommand : mRunningCommands)
+		QueuedCommand(mGenMan);
+
+	bool bRanCommands = mRunningCommands.size() > 0;
+	mRunningCommands.clear();
+	return bRanCommands;
+}
+
+void SimulationThread::WriteStatus()
+{
+	std::lock_guard<std::mutex> Lock(mStatusMutex);
+
+	mStatus.mState = mGenMan->mCurrentState;
+	mStatus.mCurrentGeneration = mGenMan->mCurrentGeneration;
+	mStatus.mNumberOfGenerations = mGenMan->mNumberOfGenerations;
+	mStatus.mCurrentGenerationDuration = mGenMan->mCurrentGenerationDuration;
+	mStatus.mGenerationDurationSeconds = mGenMan->mGenerationDurationSeconds;
+
+	mStatus.mSortedFitness.clear();
+	for (auto& [SortedCreature, Fitness] : mGenMan->mSortedCreatures)
+		mStatus.mSortedFitness.push_back(Fitness);
+	mStatus.mDisplayedCreatureIndex = mGenMan->mDisplayedCreatureIndex;
+
+	mStatus.mLoadedCreatures.resize(mGenMan->mLoadedCreatures.size());
+	for (unsigned int i = 0; i < mGenMan->mLoadedCreatures.size(); i++)
+	{
+		mStatus.mLoadedCreatures[i].mName = mGenMan->mLoadedCreatureNames[i];
+		mStatus.mLoadedCreatures[i].bActive = mGenMan->mLoadedCreatures[i]->bActive;
+		mStatus.mLoadedCreatures[i].bDrawBoundingBox = mGenMan->mLoadedCreatures[i]->bDrawBoundingBox;
+	}
+
+	mStatus.bParallelStepping = mGenMan->bParallelStepping;
+	mStatus.mEvolutionMode = mGenMan->mEvolutionMode;
+	mStatus.bEarlyStop = mGenMan->mEarlyStop.bEnabled;
+	mStatus.mSceneMode = mGenMan->mSceneMode;
+
+	mStatus.mMaxStepsPerBatch = mScheduler.mMaxStepsPerFrame;
+	mStatus.mStepsLastBatch = mScheduler.mStepsLastFrame;
+	mStatus.mDroppedTime = mScheduler.mDroppedTime;
+
+	mStatus.mVersion = mStatusVersion + 1;
+	mStatusVersion = mStatus.mVersion;
+}
+
+void SimulationThread::Run()
+{
+	auto LastTime = std::chrono::high_resolution_clock::now();
+
+	while (bRunning)
+	{
+		auto Now = std::chrono::high_resolution_clock::now();
+		double DeltaSeconds = std::chrono::duration<double>(Now - LastTime).count();
+		LastTime = Now;
+
+		bool bChanged = RunCommands();
+
+		unsigned int Steps = mScheduler.Advance(DeltaSeconds);
+		for (unsigned int i = 0; i < Steps; i++)
+			Step();
+
+		bChanged = bChanged || Steps > 0;
+		if (bChanged)
+		{
+			PoseSnapshot& Snapshot = mSnapshots.GetWriteSnapshot();
+			Snapshot.Clear();
+			mGenMan->WritePoseSnapshot(Snapshot);
+			Snapshot.mSimulatedTime = (double)mScheduler.mTotalSteps * mScheduler.mStepSize;
+
+			WriteStatus();
+			mSnapshots.Publish();
+			std::this_thread::yield();
+			continue;
+		}
+
+		/// Nothing to do until the next step is due, sleeping leaves the core to the render thread and the scenes
+		std::this_thread::sleep_for(std::chrono::duration<double>(mScheduler.mStepSize - mScheduler.mAccumulator));
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "config.h"
+#include "FixedStepScheduler.h"
+#include "GenerationManager.h"
+#include "PoseSnapshot.h"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// What the UI shows about the generation manager, copied out after every batch so the render thread never has to wait for a step to read it
+struct SimulationStatus
+{
+	struct LoadedCreatureStatus
+	{
+		std::string mName;
+		bool bActive;
+		bool bDrawBoundingBox;
+	};
+
+	/// Bumped every time the status is written, 0 for a status that was never written
+	uint64_t mVersion = 0;
+
+	GenerationManagerState mState = GenerationManagerState::Nothing;
+	unsigned int mCurrentGeneration = 0;
+	unsigned int mNumberOfGenerations = 0;
+	float mCurrentGenerationDuration = 0;
+	float mGenerationDurationSeconds = 0;
+
+	/// The fitness of each of mSortedCreatures, best first
+	std::vector<float> mSortedFitness;
+	int mDisplayedCreatureIndex = -1;
+	std::vector<LoadedCreatureStatus> mLoadedCreatures;
+
+	bool bParallelStepping = false;
+	EvolutionMode mEvolutionMode = EvolutionMode::Generational;
+	bool bEarlyStop = false;
+	CreatureSceneMode mSceneMode = CreatureSceneMode::PersonalScenes;
+
+	unsigned int mMaxStepsPerBatch = 0;
+	unsigned int mStepsLastBatch = 0;
+	double mDroppedTime = 0;
+};
+
+/// Steps the generation manager on a thread of its own at a fixed rate, so a slow frame doesn't slow the evolution down and a slow step doesn't drop frames.
+/// After every batch of steps the poses of the creatures are published to mSnapshots for drawing and the status is updated for the UI
+class SimulationThread
+{
+public:
+	using Command = std::function<void(GenerationManager*)>;
+
+	GenerationManager* mGenMan;
+	FixedStepScheduler mScheduler;
+	PoseSnapshotBuffer mSnapshots;
+
+	/// While the thread is running it is the only one that may touch the generation manager and its creatures.
+	/// Changes from other threads go through here and are run on the simulation thread before its next batch
+	std::mutex mCommandMutex;
+	std::vector<Command> mCommands;
+	std::vector<Command> mRunningCommands;
+
+	std::mutex mStatusMutex;
+	SimulationStatus mStatus;
+	std::atomic<uint64_t> mStatusVersion = 0;
+
+	std::thread mThread;
+	std::atomic<bool> bRunning = false;
+
+	SimulationThread(GenerationManager* GenMan, unsigned int MaxStepsPerFrame);
+	/// Stops the thread if it is still running
+	~SimulationThread();
+
+	void Start();
+	/// Waits for the current batch of steps to finish
+	void Stop();
+
+	/// Never waits for the simulation, the command sees the generation manager as it is after the current batch
+	void Enqueue(Command NewCommand);
+	/// Copies the latest status into Out if it has changed since Out was last filled
+	void ReadStatus(SimulationStatus& Out);
+
+	void Run();
+	/// One step of whatever the generation manager is doing, the same as the single threaded loop used to do every frame
+	void Step();
+	/// Runs the queued commands, returns true if there were any
+	bool RunCommands();
+	void WriteStatus();
+};
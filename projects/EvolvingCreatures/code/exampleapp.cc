@@ -7,11 +7,13 @@
 #include <cstring>
 
 #include "render/GraphicsNode.h"
+#include "render/GLRenderBackend.h"
 #include "render/camera.h"
 #include "render/grid.h"
 #include "render/PointLightSource.h"
 
 #include <chrono>
+#include <thread>
 
 #include <PxPhysicsAPI.h>
 #include <PxPhysics.h>
@@ -21,6 +23,7 @@
 
 #include "Creature.h"
 #include "GenerationManager.h"
+#include "SimulationThread.h"
 
 #include "imgui.h"
 #include "RandomUtils.h"
@@ -108,8 +111,9 @@ void
 ExampleApp::Run()
 {
 	///// Temporarily seed the random so I don't have to worry about that mucking up my testing
-	//srand(3);
-	srand(time(NULL));
+	//SeedRandom(3);
+	uint64_t RunSeed = time(NULL);
+	SeedRandom(RunSeed);
 
 	/// ---------------------------------------- 
 	/// [BEGIN] SHADOW MAPPING
@@ -158,6 +162,18 @@ ExampleApp::Run()
 	std::shared_ptr<ShaderResource> simpleDepthShader = std::make_shared<ShaderResource>();
 	simpleDepthShader->LoadShaders("Assets\\Shaders\\simpleDepthShader.vert", "Assets\\Shaders\\simpleDepthShader.frag");
 
+	std::shared_ptr<ShaderResource> instancedLightingShader = std::make_shared<ShaderResource>();
+	instancedLightingShader->LoadShaders("Assets\\Shaders\\lightingShaderInstanced.vert", "Assets\\Shaders\\lightingShader.frag");
+
+	std::shared_ptr<ShaderResource> instancedDepthShader = std::make_shared<ShaderResource>();
+	instancedDepthShader->LoadShaders("Assets\\Shaders\\simpleDepthShaderInstanced.vert", "Assets\\Shaders\\simpleDepthShader.frag");
+
+	/// Every creature part is a cube, so after sorting the whole population is drawn with one instanced call per cube mesh
+	DrawList CreatureDrawList;
+	CreatureDrawList.mPassShaders[(int)RenderPass::Shadow] = instancedDepthShader;
+	CreatureDrawList.mPassShaders[(int)RenderPass::Main] = instancedLightingShader;
+	GLRenderBackend Backend;
+
 	GraphicsNode cube = LoadGLTF("Assets\\glTFs\\CubeglTF\\", "Cube.gltf", lightingShader, std::make_shared<TextureResource>(gridTexture));
 	GraphicsNode armCube = LoadGLTF("Assets\\glTFs\\CubeglTF\\", "Cube.gltf", lightingShader, std::make_shared<TextureResource>(gridTexture));
 
@@ -222,20 +238,28 @@ ExampleApp::Run()
 		return;
 	}
 
-	physx::PxDefaultCpuDispatcher* Dispatcher = physx::PxDefaultCpuDispatcherCreate(2);
+	/// Leave one core for the main thread, it's the one that kicks off and waits on all the scenes
+	unsigned int NumWorkerThreads = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 1;
+	physx::PxDefaultCpuDispatcher* Dispatcher = physx::PxDefaultCpuDispatcherCreate(NumWorkerThreads);
 
 	/// ------------------------------------------
 	/// [END] INIT PHYSICS
 	/// ------------------------------------------
 
 	GenerationManager* GenMan = new GenerationManager(Physics, Dispatcher, artCube);
+	GenMan->mRunSeed = RunSeed;
 
-	float mAccumulator = 0.0f;
-	float mStepSize = 1.0f / 60.0f;
+	/// Steps the creatures on its own thread, catching up with a few steps at a time when it falls behind the wall clock.
+	/// Once it is started nothing else may touch GenMan, changes are sent to it with Sim.Enqueue and everything that is shown comes from
+	/// the snapshots and the status it publishes, so a slow step never holds up a frame
+	SimulationThread Sim(GenMan, 4);
+	PoseSnapshotReader SnapshotReader;
+	SimulationStatus SimStatus;
 
 	bool bAttachCam = false;
 	int CreatureIndexToDraw = 0;
 	bool bDrawBoundingBox = false;
+	bool bCullCreatures = true;
 
 	std::vector<char*> Entries;
 	FindCreatureFiles("Creatures", Entries);
@@ -243,7 +267,7 @@ ExampleApp::Run()
 	char* SavedCreatureName = new char[30];
 	strcpy(SavedCreatureName, "NewCreature");
 
-	this->window->SetUiRender([this, &bAttachCam, GenMan, &CreatureIndexToDraw, &bDrawBoundingBox, &Entries, &SavedCreatureName]()
+	this->window->SetUiRender([this, &bAttachCam, &Sim, &SimStatus, &CreatureIndexToDraw, &bDrawBoundingBox, &Entries, &SavedCreatureName, &SnapshotReader, &CreatureDrawList, &Backend, &bCullCreatures]()
 	{
 		bool show = true;
 		// create a new window
@@ -261,9 +285,21 @@ ExampleApp::Run()
 
 		/// Debug Feature
 		char* StateNames[] = { {"Nothing"} , {"Running"}, {"Finished"}, {"Waiting"}};
-		ImGui::Text("Current state: %s", StateNames[GenMan->mCurrentState]);
-
-		if (GenMan->mCurrentState == GenerationManagerState::Finished)
+		ImGui::Text("Current state: %s", StateNames[SimStatus.mState]);
+
+		int MaxStepsPerBatch = SimStatus.mMaxStepsPerBatch;
+		if (ImGui::DragInt("Max physics steps per batch", &MaxStepsPerBatch, 1, 1, 64))
+			Sim.Enqueue([&Sim, MaxStepsPerBatch](GenerationManager* GenMan) { Sim.mScheduler.mMaxStepsPerFrame = MaxStepsPerBatch; });
+		ImGui::Text("Physics steps last batch: %d, simulation time dropped: %.2fs", SimStatus.mStepsLastBatch, SimStatus.mDroppedTime);
+		ImGui::Checkbox("Interpolate between simulation steps", &SnapshotReader.bInterpolate);
+		ImGui::Checkbox("Skip creatures outside the view", &bCullCreatures);
+		ImGui::DragInt("Only draw the creatures furthest along, 0 draws all", &SnapshotReader.mRenderTopK, 1, 0, 10000);
+		ImGui::Text("Creatures drawn: %d, culled: %d", SnapshotReader.mCreaturesGathered, SnapshotReader.mCreaturesCulled);
+		ImGui::Text("Creature draw commands: %d in %d batches, %d draw calls in the main pass", (int)CreatureDrawList.mCommands.size(), (int)CreatureDrawList.mBatches.size(), Backend.mDrawCallsLastPass);
+		const GLState::FrameStats& GLStats = GLState::Get().mLastFrame;
+		ImGui::Text("GL calls last frame: %d, %d of them draws, %d binds and %d uniforms skipped", GLStats.mCalls, GLStats.mDrawCalls, GLStats.mSkippedBinds, GLStats.mSkippedUniforms);
+
+		if (SimStatus.mState == GenerationManagerState::Finished)
 		{
 			ImGui::Text("Evolution Finished");
 
@@ -273,35 +309,39 @@ ExampleApp::Run()
 			{
 				CreatureIndexToDraw--;
 				if (CreatureIndexToDraw < 0)
-					CreatureIndexToDraw = GenMan->mSortedCreatures.size() - 1;
+					CreatureIndexToDraw = SimStatus.mSortedFitness.size() - 1;
 			}
 			ImGui::SameLine();
 			if (ImGui::Button("Next"))
 			{
 				CreatureIndexToDraw++;
-				if (CreatureIndexToDraw >= GenMan->mSortedCreatures.size())
+				if (CreatureIndexToDraw >= SimStatus.mSortedFitness.size())
 					CreatureIndexToDraw = 0;
 			}
 
 			ImGui::InputText("Creature Name", SavedCreatureName, 30);
 			if (ImGui::Button("Save Creature"))
 			{
-				SaveCreatureToFile(GenMan->mSortedCreatures[CreatureIndexToDraw].first, "Creatures/" + std::string(SavedCreatureName) + ".creature");
+				std::string FileName = "Creatures/" + std::string(SavedCreatureName) + ".creature";
+				Sim.Enqueue([CreatureIndex = CreatureIndexToDraw, FileName](GenerationManager* GenMan) {
+					if (CreatureIndex < GenMan->mSortedCreatures.size())
+						SaveCreatureToFile(GenMan->mSortedCreatures[CreatureIndex].first, FileName);
+				});
 				strcpy(SavedCreatureName, "NewCreature");
 			}
-			ImGui::Text("Drawing creature %d/%d", CreatureIndexToDraw, GenMan->mSortedCreatures.size() - 1);
+			ImGui::Text("Drawing creature %d/%d", CreatureIndexToDraw, (int)SimStatus.mSortedFitness.size() - 1);
 			ImGui::Text("Creature Stats");
-			ImGui::Text("Creature Fitness: %f", GenMan->mSortedCreatures[CreatureIndexToDraw].second);
+			ImGui::Text("Creature Fitness: %f", SimStatus.mSortedFitness[CreatureIndexToDraw]);
 
 			ImGui::Checkbox("Follow creature", &bAttachCam);
 
 
 			if (ImGui::Button("Finish"))
 			{
-				GenMan->mCurrentState = GenerationManagerState::Nothing;
+				Sim.Enqueue([](GenerationManager* GenMan) { GenMan->mCurrentState = GenerationManagerState::Nothing; });
 			}
 		}
-		else if (GenMan->mCurrentState == GenerationManagerState::Nothing)
+		else if (SimStatus.mState == GenerationManagerState::Nothing)
 		{
 			ImGui::Columns(2);
 			ImGui::Text("Saved Creatures");
@@ -316,42 +356,68 @@ ExampleApp::Run()
 				ImGui::ListBox("", &CurrentItem, Entries.data(), Entries.size(), 5);
 				if (ImGui::Button("Load Creature"))
 				{
-					GenMan->LoadCreature(Entries[CurrentItem]);
+					Sim.Enqueue([FileName = std::string(Entries[CurrentItem])](GenerationManager* GenMan) { GenMan->LoadCreature(FileName); });
 				}
 			}
 
-			if (GenMan->mLoadedCreatureNames.size() > 0)
+			if (SimStatus.mLoadedCreatures.size() > 0)
 			{
 				static int CurrentItem = 0;
+				static std::vector<const char*> LoadedCreatureNames;
+				LoadedCreatureNames.clear();
+				for (auto& Loaded : SimStatus.mLoadedCreatures)
+					LoadedCreatureNames.push_back(Loaded.mName.c_str());
+
 				ImGui::Text("");
 				ImGui::Text("Loaded Creatures");
-				ImGui::ListBox(" ", &CurrentItem, GenMan->mLoadedCreatureNames.data(), GenMan->mLoadedCreatureNames.size(), 5);
+				ImGui::ListBox(" ", &CurrentItem, LoadedCreatureNames.data(), LoadedCreatureNames.size(), 5);
 
-				if (CurrentItem >= GenMan->mLoadedCreatures.size())
+				if (CurrentItem >= SimStatus.mLoadedCreatures.size())
 				{
-					CurrentItem = GenMan->mLoadedCreatures.size() - 1;
+					CurrentItem = SimStatus.mLoadedCreatures.size() - 1;
 				}
 
+				/// The list may have changed by the time the simulation gets to the command, so every command checks the index again
 				bool bToRemove = ImGui::Button("Remove");
 
 				ImGui::SameLine();
 
 				if (ImGui::Button("Move to spawn"))
 				{
-					GenMan->SetLoadedCreaturePosition(CurrentItem, vec3(0, 20, 0));
+					Sim.Enqueue([CreatureIndex = CurrentItem](GenerationManager* GenMan) {
+						if (CreatureIndex < GenMan->mLoadedCreatures.size())
+							GenMan->SetLoadedCreaturePosition(CreatureIndex, vec3(0, 20, 0));
+					});
 				}
 
 				ImGui::SameLine();
 
-				ImGui::Checkbox("Active", &GenMan->mLoadedCreatures[CurrentItem]->bActive);
+				bool bActive = SimStatus.mLoadedCreatures[CurrentItem].bActive;
+				if (ImGui::Checkbox("Active", &bActive))
+				{
+					Sim.Enqueue([CreatureIndex = CurrentItem, bActive](GenerationManager* GenMan) {
+						if (CreatureIndex < GenMan->mLoadedCreatures.size())
+							GenMan->mLoadedCreatures[CreatureIndex]->bActive = bActive;
+					});
+				}
 
 				ImGui::SameLine();
 
-				ImGui::Checkbox("Draw Bounding Boxes", &GenMan->mLoadedCreatures[CurrentItem]->bDrawBoundingBox);
+				bool bDrawBoxes = SimStatus.mLoadedCreatures[CurrentItem].bDrawBoundingBox;
+				if (ImGui::Checkbox("Draw Bounding Boxes", &bDrawBoxes))
+				{
+					Sim.Enqueue([CreatureIndex = CurrentItem, bDrawBoxes](GenerationManager* GenMan) {
+						if (CreatureIndex < GenMan->mLoadedCreatures.size())
+							GenMan->mLoadedCreatures[CreatureIndex]->bDrawBoundingBox = bDrawBoxes;
+					});
+				}
 
 				if (bToRemove)
 				{
-					GenMan->RemoveLoadedCreature(CurrentItem);
+					Sim.Enqueue([CreatureIndex = CurrentItem](GenerationManager* GenMan) {
+						if (CreatureIndex < GenMan->mLoadedCreatures.size())
+							GenMan->RemoveLoadedCreature(CreatureIndex);
+					});
 				}
 			}
 
@@ -372,10 +438,39 @@ ExampleApp::Run()
 			ImGui::Text("Generation Management");
 			ImGui::DragInt("Number of Generations", &NumberOfGenerations, 1, 1, 200);
 			ImGui::DragFloat("Evaluation Duration", &EvaluationTime, 1, 0, 120);
+			bool bParallelStepping = SimStatus.bParallelStepping;
+			if (ImGui::Checkbox("Step creatures in parallel", &bParallelStepping))
+				Sim.Enqueue([bParallelStepping](GenerationManager* GenMan) { GenMan->bParallelStepping = bParallelStepping; });
+
+			bool bSteadyState = SimStatus.mEvolutionMode == EvolutionMode::SteadyState;
+			if (ImGui::Checkbox("Replace creatures continuously", &bSteadyState) && SimStatus.mState != Running)
+			{
+				Sim.Enqueue([bSteadyState](GenerationManager* GenMan) {
+					if (GenMan->mCurrentState != Running)
+						GenMan->mEvolutionMode = bSteadyState ? EvolutionMode::SteadyState : EvolutionMode::Generational;
+				});
+			}
+
+			bool bEarlyStop = SimStatus.bEarlyStop;
+			if (ImGui::Checkbox("Stop hopeless evaluations early", &bEarlyStop))
+				Sim.Enqueue([bEarlyStop](GenerationManager* GenMan) { GenMan->mEarlyStop.bEnabled = bEarlyStop; });
+
+			bool bSharedScene = SimStatus.mSceneMode == CreatureSceneMode::SharedScene;
+			if (ImGui::Checkbox("Simulate generation in one scene", &bSharedScene) && SimStatus.mState != Running)
+			{
+				Sim.Enqueue([bSharedScene](GenerationManager* GenMan) {
+					if (GenMan->mCurrentState != Running)
+						GenMan->mSceneMode = bSharedScene ? CreatureSceneMode::SharedScene : CreatureSceneMode::PersonalScenes;
+				});
+			}
 
 			if (ImGui::Button("Start"))
 			{
-				GenMan->Start(NumberOfGenerations, EvaluationTime, GenerationSurvivors, MutationChance, MutationSeverity, NumberOfCreatures, bUseLoadedCreatures);
+				/// The options are statics, so they are copied here rather than read by the simulation thread later
+				Sim.Enqueue([Generations = NumberOfGenerations, Duration = EvaluationTime, Survivors = GenerationSurvivors, Chance = MutationChance,
+					Severity = MutationSeverity, Population = NumberOfCreatures, bUseLoaded = bUseLoadedCreatures](GenerationManager* GenMan) {
+					GenMan->Start(Generations, Duration, Survivors, Chance, Severity, Population, bUseLoaded);
+				});
 			}
 			ImGui::Columns(1);
 		}
@@ -390,10 +485,10 @@ ExampleApp::Run()
 			ImGui::Text("Mutation Severity: %.1f%%", MutationSeverity * 100);
 
 			ImGui::NextColumn();
-			ImGui::Text("On Generation: %d/%d", GenMan->mCurrentGeneration, GenMan->mNumberOfGenerations);
-			ImGui::Text("Been running for: %.2f/%.2f", GenMan->mCurrentGenerationDuration, GenMan->mGenerationDurationSeconds);
+			ImGui::Text("On Generation: %d/%d", SimStatus.mCurrentGeneration, SimStatus.mNumberOfGenerations);
+			ImGui::Text("Been running for: %.2f/%.2f", SimStatus.mCurrentGenerationDuration, SimStatus.mGenerationDurationSeconds);
 
-			float CurrentProgress = (((GenMan->mCurrentGeneration * GenMan->mGenerationDurationSeconds) + GenMan->mCurrentGenerationDuration) / (GenMan->mNumberOfGenerations * GenMan->mGenerationDurationSeconds));
+			float CurrentProgress = (((SimStatus.mCurrentGeneration * SimStatus.mGenerationDurationSeconds) + SimStatus.mCurrentGenerationDuration) / (SimStatus.mNumberOfGenerations * SimStatus.mGenerationDurationSeconds));
 
 			ImGui::Text("Progress: %.2f%%", CurrentProgress * 100);
 			ImGui::Columns(1);
@@ -405,32 +500,37 @@ ExampleApp::Run()
 
 	const auto [ SCR_WIDTH, SCR_HEIGHT ] = window->GetWidthHeight();
 
+	Sim.Start();
+
 	while (this->window->IsOpen())
 	{
 		auto end = std::chrono::high_resolution_clock::now();
-		float deltaseconds = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() / 1000.0f;
+		float deltaseconds = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000000.0f;
 		float timesincestart = std::chrono::duration_cast<std::chrono::milliseconds>(end - appStart).count() / 1000.0f;
 		start = std::chrono::high_resolution_clock::now();
 
-		GenMan->Update(deltaseconds);
-
-		mAccumulator += deltaseconds;
-		if (mAccumulator > mStepSize)
-		{
-			if (GenMan->mCurrentState != GenerationManagerState::Waiting)
-				GenMan->Activate();
+		Sim.ReadStatus(SimStatus);
+		SnapshotReader.Refresh(Sim.mSnapshots);
 
-			if (GenMan->mCurrentState == GenerationManagerState::Nothing)
-				GenMan->ActivateLoadedCreatures();
+		const PoseSnapshot& Snapshot = SnapshotReader.mCurrent;
+		const PoseSnapshot::CreatureEntry* DisplayedCreature = Snapshot.mDisplayedCreature >= 0 ? &Snapshot.mCreatures[Snapshot.mDisplayedCreature] : nullptr;
 
-			GenMan->Simulate(mStepSize);
-
-			mAccumulator -= mStepSize;
+		if (SimStatus.mState == GenerationManagerState::Finished)
+		{
+			if (CreatureIndexToDraw >= SimStatus.mSortedFitness.size())
+				CreatureIndexToDraw = 0;
+
+			/// Asked for again every frame until the simulation has picked it up, doing it twice does nothing
+			if (CreatureIndexToDraw != SimStatus.mDisplayedCreatureIndex)
+				Sim.Enqueue([CreatureIndex = CreatureIndexToDraw](GenerationManager* GenMan) {
+					if (CreatureIndex < GenMan->mSortedCreatures.size())
+						GenMan->SetDisplayedCreature(CreatureIndex);
+				});
 		}
-		
-		if (GenMan->mCurrentState == GenerationManagerState::Finished && bAttachCam)
+
+		if (SimStatus.mState == GenerationManagerState::Finished && bAttachCam && DisplayedCreature != nullptr)
 		{
-			auto PV = GenMan->mSortedCreatures[CreatureIndexToDraw].first->mRootPart->mLink->getGlobalPose().p;
+			auto PV = Snapshot.mPoses[DisplayedCreature->mFirstPart].p;
 			vec3 v(PV.x, PV.y, PV.z);
 			cam.mTarget = v;
 
@@ -442,6 +542,9 @@ ExampleApp::Run()
 		auto frameStart = std::chrono::high_resolution_clock::now();
 		std::chrono::duration<double> elapsed_seconds{ frameStart - appStart };
 		
+		/// The UI drew with its own program and textures at the end of last frame
+		GLState::Get().BeginFrame();
+
 		glEnable(GL_DEPTH_TEST);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -450,15 +553,25 @@ ExampleApp::Run()
 		// do stuff
 		sun.UpdateShader(&*shader);
 		sun.UpdateShader(&*lightingShader);
-		
-		GenMan->UpdateCreatures(deltaseconds);
-		
+		sun.UpdateShader(&*instancedLightingShader);
+
 		mat4 view = cam.GetView();
 		mat4 viewProjection = projection * view;
 
 		/// For Shadow Mapping
 		mat4 lightView = lookat(vec3(-2, 4, -1), vec3(0, 0, 0), vec3(0, 1, 0));
 		mat4 lightSpaceMatrix = lightProjection * lightView;
+
+		/// A creature is only recorded into the passes that can see it, the shadow pass looks from the light
+		Frustum PassFrustums[(int)RenderPass::Count];
+		PassFrustums[(int)RenderPass::Shadow] = Frustum(lightSpaceMatrix);
+		PassFrustums[(int)RenderPass::Main] = Frustum(viewProjection);
+		const Frustum* CullFrustums = bCullCreatures ? PassFrustums : nullptr;
+
+		/// Record everything that will be drawn this frame, both passes below are submitted from the same sorted list
+		CreatureDrawList.Clear();
+		SnapshotReader.Gather(CreatureDrawList, CullFrustums);
+		CreatureDrawList.Sort();
 		
 		shader->UseProgram();
 		shader->SetVec3("viewPos", cam.mPosition);
@@ -466,6 +579,9 @@ ExampleApp::Run()
 		lightingShader->UseProgram();
 		lightingShader->SetVec3("viewPos", cam.mPosition);
 
+		instancedLightingShader->UseProgram();
+		instancedLightingShader->SetVec3("viewPos", cam.mPosition);
+
 		/// ----------------------------------------
 		/// [BEGIN] MORE SHADOW MAPPING STUFF
 		/// ----------------------------------------
@@ -473,33 +589,30 @@ ExampleApp::Run()
 		glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
 		glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
 			glClear(GL_DEPTH_BUFFER_BIT);
-			GenMan->DrawCreatures(viewProjection, simpleDepthShader);
+			Backend.Submit(CreatureDrawList, RenderPass::Shadow, lightSpaceMatrix);
 			Quad.draw(lightSpaceMatrix, simpleDepthShader);
 		glBindFramebuffer(GL_FRAMEBUFFER, 0);
 		glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		glBindTexture(GL_TEXTURE_2D, depthMap);
+		GLState::Get().BindTexture(1, depthMap);
 
 		/// ----------------------------------------
 		/// [END] MORE SHADOW MAPPING STUFF
 		/// ----------------------------------------
 
-		if (GenMan->mCurrentState == GenerationManagerState::Running || GenMan->mCurrentState == GenerationManagerState::Waiting)
-		{
-			GenMan->DrawCreatures(viewProjection);
-		}
-		else if (GenMan->mCurrentState == GenerationManagerState::Finished)
-		{
-			GenMan->DrawFinishedCreatures(viewProjection, CreatureIndexToDraw);
-			if (bDrawBoundingBox)
-				GenMan->mSortedCreatures[CreatureIndexToDraw].first->DrawBoundingBoxes(viewProjection, vec3(0, 20, 0), cube);
-		}
+		Backend.Submit(CreatureDrawList, RenderPass::Main, viewProjection);
 
-		GenMan->UpdateAndDrawLoadedCreatures(viewProjection, deltaseconds);
-		for (auto Thing : GenMan->mLoadedCreatures)
+		/// Only the creatures whose boxes were asked for have any in the snapshot
+		for (auto& Entry : Snapshot.mCreatures)
 		{
-			if (Thing->bDrawBoundingBox)
-				Thing->mCreature->DrawBoundingBoxes(viewProjection, vec3(0, 20, 0), cube);
+			if (&Entry == DisplayedCreature && !bDrawBoundingBox)
+				continue;
+
+			for (unsigned int Box = Entry.mFirstBox; Box < Entry.mFirstBox + Entry.mNumBoxes; Box++)
+			{
+				cube.transform = translate(vec3(0, 20, 0)) * Snapshot.mBoundingBoxes[Box];
+				cube.draw(viewProjection);
+			}
 		}
 
 		Quad.draw(viewProjection);
@@ -517,6 +630,9 @@ ExampleApp::Run()
 	/// [BEGIN] SHUTDOWN PHYSICS
 	/// ------------------------------------------
 
+	Sim.Stop();
+	delete GenMan;
+	Dispatcher->release();
 	Physics->release();
 	Foundation->release();
 
@@ -0,0 +1,366 @@
+//------------------------------------------------------------------------------
+// headless/main.cc
+// (C) 2015-2022 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include <algorithm>
+#include <cstring>
+#include <chrono>
+#include <ctime>
+#include <thread>
+#include <iostream>
+
+#include <PxPhysicsAPI.h>
+
+#include "Creature.h"
+#include "GenerationManager.h"
+#include "RandomUtils.h"
+#include "render/DrawList.h"
+#include "PoseSnapshot.h"
+
+/// Runs the evolution without a window, GL context or ImGui, stepping the physics as fast as the CPU allows.
+/// Generation length is measured in simulated time so the results match a run in the windowed app.
+
+static void PrintUsage()
+{
+	std::cout << "Usage: EvolvingCreaturesHeadless [options]\n"
+		<< "  --generations <int>        Number of generations to run (default 5)\n"
+		<< "  --population <int>         Creatures per generation (default 50)\n"
+		<< "  --survivors <int>          Creatures kept each generation (default 15)\n"
+		<< "  --duration <float>         Simulated seconds per generation (default 20)\n"
+		<< "  --mutation-chance <float>  Odds of each mutation event (default 0.3)\n"
+		<< "  --mutation-severity <float> How much a value can mutate by (default 0.15)\n"
+		<< "  --step <float>             Physics step size in seconds (default 1/60)\n"
+		<< "  --shared-scene             Simulate the whole generation in one scene\n"
+		<< "  --steady-state             Replace each creature as soon as it has been evaluated instead of whole generations at once\n"
+		<< "  --early-stop               Stop evaluating creatures that blew up, stopped moving or can't reach the survivors anymore\n"
+		<< "  --build-threads <int>      Threads that build each new generation, 0 for one per core (default 0)\n"
+		<< "  --benchmark-controller     Time the per-step controller update for growing populations instead of evolving\n"
+		<< "  --benchmark-draw-list      Time recording, sorting and submitting the population to a null renderer instead of evolving\n"
+		<< "  --self-test-draw-list      Check that the draw list sorts and batches a known set of draws as expected, exits with 1 if it doesn't\n"
+		<< "  --seed <int>               Random seed, uses the time if not given\n"
+		<< "  --save <file>              Save the best creature to this file when done\n";
+}
+
+/// Times GenerationManager::Activate on its own, for populations growing by 10x up to MaxPopulation, so the controller cost can be compared against the population size
+static void RunControllerBenchmark(GenerationManager* GenMan, int MaxPopulation, float StepSize)
+{
+	const int TicksPerPopulation = 1000;
+
+	for (int Population = std::min(10, MaxPopulation); ; Population = std::min(Population * 10, MaxPopulation))
+	{
+		GenMan->GenerateCreatures(Population, false);
+
+		/// Spread the creatures out over the oscillation so they don't all evaluate the same sin
+		int JointCount = 0;
+		for (int i = 0; i < GenMan->mCreatures.size(); i++)
+		{
+			GenMan->mCreatures[i]->mLifetime = i * StepSize;
+			JointCount += GenMan->mCreatures[i]->mCreature->mJointControllers.size();
+		}
+
+		/// Warm up once so the first tick doesn't pay for any cache misses the rest won't
+		GenMan->Activate();
+
+		auto Start = std::chrono::high_resolution_clock::now();
+		for (int Tick = 0; Tick < TicksPerPopulation; Tick++)
+			GenMan->Activate();
+		float TotalMicroseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - Start).count() / 1000.f;
+
+		float MicrosecondsPerTick = TotalMicroseconds / TicksPerPopulation;
+		std::cout << "Population " << Population << " (" << JointCount << " joints): " 
+			<< MicrosecondsPerTick << "us per tick, " 
+			<< MicrosecondsPerTick * 1000.f / Population << "ns per creature\n";
+
+		if (Population >= MaxPopulation)
+			break;
+	}
+}
+
+/// Records a snapshot of the population into a draw list, sorts it and submits both passes to a backend that draws nothing, for populations growing by 10x up to MaxPopulation.
+/// Shows what the render side costs on the CPU and how many draw calls sorting and batching leave, without needing a GPU
+static void RunDrawListBenchmark(GenerationManager* GenMan, int MaxPopulation)
+{
+	const int FramesPerPopulation = 1000;
+
+	/// Shaders that were never loaded don't touch GL, the null backend only needs something to tell the passes apart
+	DrawList List;
+	List.mPassShaders[(int)RenderPass::Shadow] = std::make_shared<ShaderResource>();
+	List.mPassShaders[(int)RenderPass::Main] = std::make_shared<ShaderResource>();
+	NullRenderBackend Backend;
+	mat4 ViewProjection;
+
+	/// Nothing is stepped, so there is nothing to interpolate between
+	PoseSnapshotBuffer Snapshots;
+	PoseSnapshotReader Reader;
+	Reader.bInterpolate = false;
+
+	for (int Population = std::min(10, MaxPopulation); ; Population = std::min(Population * 10, MaxPopulation))
+	{
+		GenMan->GenerateCreatures(Population, false);
+
+		/// The generation isn't started, so the snapshot is filled with the whole population directly
+		PoseSnapshot& Snapshot = Snapshots.GetWriteSnapshot();
+		Snapshot.Clear();
+		for (auto Bundle : GenMan->mCreatures)
+			Snapshot.AddCreature(*Bundle->mCreature, &GenMan->mCubeNode.meshes, 0);
+		Snapshots.Publish();
+		Reader.Refresh(Snapshots);
+		Backend.Reset();
+
+		auto Start = std::chrono::high_resolution_clock::now();
+		for (int Frame = 0; Frame < FramesPerPopulation; Frame++)
+		{
+			List.Clear();
+			Reader.Gather(List, nullptr);
+			List.Sort();
+			Backend.Submit(List, RenderPass::Shadow, ViewProjection);
+			Backend.Submit(List, RenderPass::Main, ViewProjection);
+		}
+		float TotalMicroseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - Start).count() / 1000.f;
+
+		std::cout << "Population " << Population << " (" << List.mCommands.size() << " draw commands): "
+			<< TotalMicroseconds / FramesPerPopulation << "us per frame, "
+			<< Backend.mStats.mDrawCalls / FramesPerPopulation << " draw calls and "
+			<< Backend.mStats.mShaderChanges / FramesPerPopulation << " shader changes per frame\n";
+
+		if (Population >= MaxPopulation)
+			break;
+	}
+}
+
+/// Records a known set of draws into a draw list, sorts it and checks the batches a recording null backend is given.
+/// Needs neither GL nor PhysX, resources that were never loaded are only ever compared by address
+static bool RunDrawListSelfTest()
+{
+	bool bPassed = true;
+	auto Check = [&bPassed](bool bCondition, const char* What)
+	{
+		if (!bCondition)
+		{
+			std::cout << "FAILED: " << What << "\n";
+			bPassed = false;
+		}
+	};
+
+	MeshResource MeshA, MeshB;
+	ShaderResource ShaderA, ShaderB;
+
+	/// The x of each transform is the order it was added in, so the sorted transforms show where every draw ended up
+	DrawList List;
+	List.Add(RenderPass::Main, &MeshA, &ShaderA, translate(vec3(0, 0, 0)));
+	List.Add(RenderPass::Shadow, &MeshB, &ShaderA, translate(vec3(1, 0, 0)));
+	List.Add(RenderPass::Main, &MeshA, &ShaderB, translate(vec3(2, 0, 0)));
+	List.Add(RenderPass::Main, &MeshB, &ShaderA, translate(vec3(3, 0, 0)));
+	List.Add(RenderPass::Main, &MeshA, &ShaderA, translate(vec3(4, 0, 0)));
+	List.Add(RenderPass::Shadow, &MeshB, &ShaderA, translate(vec3(5, 0, 0)));
+	List.Sort();
+
+	/// By pass, then by shader and mesh in the order they were first seen, draws that share all three keep the order they were added in
+	const DrawBatch Expected[] = {
+		{ RenderPass::Shadow, &MeshB, &ShaderA, 0, 2 },
+		{ RenderPass::Main, &MeshA, &ShaderA, 2, 2 },
+		{ RenderPass::Main, &MeshB, &ShaderA, 4, 1 },
+		{ RenderPass::Main, &MeshA, &ShaderB, 5, 1 },
+	};
+	const float ExpectedOrder[] = { 1, 5, 0, 4, 3, 2 };
+	const int NumExpected = sizeof(Expected) / sizeof(Expected[0]);
+
+	Check(List.mSortedTransforms.size() == 6, "every draw has a sorted transform");
+	for (int i = 0; i < List.mSortedTransforms.size() && i < 6; i++)
+		Check(List.mSortedTransforms[i][3].x == ExpectedOrder[i], "draws are sorted by pass, shader and mesh and keep their order otherwise");
+
+	NullRenderBackend Backend;
+	Backend.bRecord = true;
+	Backend.Submit(List, RenderPass::Shadow, mat4());
+	Backend.Submit(List, RenderPass::Main, mat4());
+
+	Check(Backend.mRecorded.size() == NumExpected, "runs of the same pass, shader and mesh are merged into one batch each");
+	for (int i = 0; i < Backend.mRecorded.size() && i < NumExpected; i++)
+	{
+		const DrawBatch& Batch = Backend.mRecorded[i];
+		Check(Batch.mPass == Expected[i].mPass && Batch.mMesh == Expected[i].mMesh && Batch.mShader == Expected[i].mShader, "batches come out in sorted order");
+		Check(Batch.mFirst == Expected[i].mFirst && Batch.mCount == Expected[i].mCount, "batches cover the right sorted transforms");
+	}
+
+	Check(Backend.mStats.mDrawCalls == 4 && Backend.mStats.mInstances == 6, "one draw call per batch");
+	Check(Backend.mStats.mShaderChanges == 3 && Backend.mStats.mMeshChanges == 4, "shader and mesh changes are only counted between batches that differ");
+
+	std::cout << (bPassed ? "Draw list self test passed\n" : "Draw list self test failed\n");
+	return bPassed;
+}
+
+int
+main(int argc, const char** argv)
+{
+	int NumberOfGenerations = 5;
+	int NumberOfCreatures = 50;
+	int GenerationSurvivors = 15;
+	float EvaluationTime = 20;
+	float MutationChance = 0.3;
+	float MutationSeverity = 0.15;
+	float StepSize = 1.0f / 60.0f;
+	unsigned int Seed = (unsigned int)time(NULL);
+	std::string SaveFileName;
+	bool bSharedScene = false;
+	bool bSteadyState = false;
+	bool bEarlyStop = false;
+	bool bBenchmarkController = false;
+	bool bBenchmarkDrawList = false;
+	bool bSelfTestDrawList = false;
+	unsigned int BuildThreads = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		bool bHasValue = i + 1 < argc;
+
+		if (strcmp(argv[i], "--generations") == 0 && bHasValue)
+			NumberOfGenerations = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--population") == 0 && bHasValue)
+			NumberOfCreatures = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--survivors") == 0 && bHasValue)
+			GenerationSurvivors = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--duration") == 0 && bHasValue)
+			EvaluationTime = (float)atof(argv[++i]);
+		else if (strcmp(argv[i], "--mutation-chance") == 0 && bHasValue)
+			MutationChance = (float)atof(argv[++i]);
+		else if (strcmp(argv[i], "--mutation-severity") == 0 && bHasValue)
+			MutationSeverity = (float)atof(argv[++i]);
+		else if (strcmp(argv[i], "--step") == 0 && bHasValue)
+			StepSize = (float)atof(argv[++i]);
+		else if (strcmp(argv[i], "--shared-scene") == 0)
+			bSharedScene = true;
+		else if (strcmp(argv[i], "--steady-state") == 0)
+			bSteadyState = true;
+		else if (strcmp(argv[i], "--early-stop") == 0)
+			bEarlyStop = true;
+		else if (strcmp(argv[i], "--build-threads") == 0 && bHasValue)
+			BuildThreads = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--benchmark-controller") == 0)
+			bBenchmarkController = true;
+		else if (strcmp(argv[i], "--benchmark-draw-list") == 0)
+			bBenchmarkDrawList = true;
+		else if (strcmp(argv[i], "--self-test-draw-list") == 0)
+			bSelfTestDrawList = true;
+		else if (strcmp(argv[i], "--seed") == 0 && bHasValue)
+			Seed = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--save") == 0 && bHasValue)
+			SaveFileName = argv[++i];
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (bSelfTestDrawList)
+		return RunDrawListSelfTest() ? 0 : 1;
+
+	if (GenerationSurvivors > NumberOfCreatures)
+		GenerationSurvivors = NumberOfCreatures;
+
+	SeedRandom(Seed);
+
+	/// ------------------------------------------
+	/// [BEGIN] INIT PHYSICS
+	/// ------------------------------------------
+
+	physx::PxDefaultAllocator DefaultAllocatorCallback;
+	physx::PxDefaultErrorCallback DefaultErrorCallback;
+
+	physx::PxFoundation* Foundation = PxCreateFoundation(PX_PHYSICS_VERSION, DefaultAllocatorCallback, DefaultErrorCallback);
+	if (!Foundation)
+	{
+		std::cout << "Completely broken!\n";
+		return 1;
+	}
+
+	physx::PxPhysics* Physics = PxCreatePhysics(PX_PHYSICS_VERSION, *Foundation, physx::PxTolerancesScale(), false, nullptr);
+	if (!Physics)
+	{
+		std::cout << "Completely broken!\n";
+		return 1;
+	}
+
+	unsigned int NumWorkerThreads = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 1;
+	physx::PxDefaultCpuDispatcher* Dispatcher = physx::PxDefaultCpuDispatcherCreate(NumWorkerThreads);
+
+	/// ------------------------------------------
+	/// [END] INIT PHYSICS
+	/// ------------------------------------------
+
+	/// Nothing is ever drawn, so the creatures just get an empty node
+	GenerationManager* GenMan = new GenerationManager(Physics, Dispatcher, GraphicsNode());
+	GenMan->mStepSize = StepSize;
+	GenMan->mRunSeed = Seed;
+	GenMan->mBuildThreads = BuildThreads;
+	if (bSharedScene)
+		GenMan->mSceneMode = CreatureSceneMode::SharedScene;
+	if (bSteadyState)
+		GenMan->mEvolutionMode = EvolutionMode::SteadyState;
+	GenMan->mEarlyStop.bEnabled = bEarlyStop;
+
+	if (bBenchmarkController)
+	{
+		RunControllerBenchmark(GenMan, NumberOfCreatures, StepSize);
+	}
+	else if (bBenchmarkDrawList)
+	{
+		RunDrawListBenchmark(GenMan, NumberOfCreatures);
+	}
+	else
+	{
+		std::cout << "Running " << NumberOfGenerations << " generations of " << NumberOfCreatures << " creatures, " 
+			<< EvaluationTime << "s each, seed " << Seed << "\n";
+
+		auto RunStart = std::chrono::high_resolution_clock::now();
+		auto GenerationStart = RunStart;
+
+		GenMan->Start(NumberOfGenerations, EvaluationTime, GenerationSurvivors, MutationChance, MutationSeverity, NumberOfCreatures, false);
+
+		size_t GenerationsReported = 0;
+		while (GenMan->mCurrentState == GenerationManagerState::Running)
+		{
+			GenMan->Tick();
+
+			/// Report each generation as soon as it has been evaluated
+			while (GenerationsReported < GenMan->mGenerationBestFitness.size())
+			{
+				auto Now = std::chrono::high_resolution_clock::now();
+				float GenerationSeconds = std::chrono::duration_cast<std::chrono::milliseconds>(Now - GenerationStart).count() / 1000.f;
+				GenerationStart = Now;
+
+				std::cout << "Generation " << GenerationsReported + 1 << "/" << NumberOfGenerations 
+					<< " best fitness: " << GenMan->mGenerationBestFitness[GenerationsReported] 
+					<< " (" << GenerationSeconds << "s wall time)\n";
+				GenerationsReported++;
+			}
+		}
+
+		float RunSeconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - RunStart).count() / 1000.f;
+		std::cout << "Finished in " << RunSeconds << "s, simulated " << NumberOfGenerations * EvaluationTime << "s\n";
+		std::cout << GenMan->mFitnessCacheHits << " creatures reused a known fitness instead of being evaluated\n";
+		std::cout << GenMan->mEarlyStopCount << " evaluations were stopped early\n";
+
+		if (!SaveFileName.empty() && GenMan->mSortedCreatures.size() > 0)
+		{
+			SaveCreatureToFile(GenMan->mSortedCreatures[0].first, SaveFileName);
+			std::cout << "Saved best creature to " << SaveFileName << "\n";
+		}
+	}
+
+	/// ------------------------------------------
+	/// [BEGIN] SHUTDOWN PHYSICS
+	/// ------------------------------------------
+
+	delete GenMan;
+	Dispatcher->release();
+	Physics->release();
+	Foundation->release();
+
+	/// ------------------------------------------
+	/// [END] SHUTDOWN PHYSICS
+	/// ------------------------------------------
+
+	return 0;
+}